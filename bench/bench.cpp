@@ -0,0 +1,731 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/resource.h>
+#endif
+#include "core/gamemap.h"
+#include "core/movegenerator.h"
+#include "core/pathfinder.h"
+#include "core/query.h"
+#include "util/threadpool.h"
+
+/*!
+    \file bench.cpp
+    \brief Benchmark for game map storage and search engines expansion rate.
+
+    Generates reproducible maps (from fixed seed) of sizes from 9x9 up to 4096x4096 and of
+    several topologies (see Topology): random single-cell walls of given density, large square
+    blocks (where Jump Point Search gains the most), perfect maze, rooms connected by doors and
+    spiral. Runs two query mixes with each search engine: random pairs (random ball and random
+    empty cell) and far pairs (ball in top-left corner area, empty cell in bottom-right one).
+    For every run prints memory per cell, median and 99th percentile of query latency, count
+    of expanded nodes per second and peak memory (resident set size) of process so far; for
+    hierarchical engine also build time and memory of abstract graph of clusters and share of
+    paths longer than the shortest ones (found by A*, not timed) with their mean and maximal
+    length ratio, and for A* with landmarks (ALT) build time and memory of landmark tables.
+
+    Then compares generation of all the legal moves (ball, target) by MoveGenerator with
+    searching path for every pair of ball and empty cell.
+
+    Then simulates game turns (move one ball, spawn three balls and clear three balls) and
+    compares incremental update of components labelling with rebuilding it every turn.
+
+    Then runs batch of queries on one shared map with 1..N threads (each thread has its own
+    PathFinder) and prints queries per second for each threads count.
+
+    Usage: ./ballpath-bench [seed [max_threads]]
+
+    Seed is a non-negative number (1 by default), max_threads is a positive number (count of
+    hardware threads by default); anything else is rejected with usage message.
+
+    With "--check" option runs self-check instead of benchmark: applies random cell changes
+    to small maps and after every one compares reachability of all the pairs of cells by
+    incrementally updated components labelling with labelling rebuilt from scratch. Exit code
+    is nonzero if they differ.
+
+    Usage: ./ballpath-bench --check [seed]
+*/
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Engine
+{
+    const char *name;
+    PathFinder::Algorithm algorithm;
+    AStarEngine::OpenListType openListType;
+    ClusterGraph::EntranceMode entranceMode; //!< Of abstract graph for Hierarchical.
+    int landmarkCount;                       //!< Landmarks for A* heuristic (0 if none).
+};
+
+const int ClusterSize = 16;
+
+const Engine Engines[] = {
+    { "astar-heap  ", PathFinder::AStar, AStarEngine::HeapOpenList,
+      ClusterGraph::SparseEntrances, 0 },
+    { "astar-bucket", PathFinder::AStar, AStarEngine::BucketOpenList,
+      ClusterGraph::SparseEntrances, 0 },
+    { "astar-alt   ", PathFinder::AStar, AStarEngine::BucketOpenList,
+      ClusterGraph::SparseEntrances, 16 },
+    { "astar-bidir ", PathFinder::BidirectionalAStar, AStarEngine::BucketOpenList,
+      ClusterGraph::SparseEntrances, 0 },
+    { "bitbfs      ", PathFinder::BitBfs, AStarEngine::BucketOpenList,
+      ClusterGraph::SparseEntrances, 0 },
+    { "jps         ", PathFinder::Jps, AStarEngine::BucketOpenList,
+      ClusterGraph::SparseEntrances, 0 },
+    { "hpa         ", PathFinder::Hierarchical, AStarEngine::BucketOpenList,
+      ClusterGraph::SparseEntrances, 0 },
+    { "hpa-optimal ", PathFinder::Hierarchical, AStarEngine::BucketOpenList,
+      ClusterGraph::AllEntrances, 0 },
+    { "auto        ", PathFinder::Auto, AStarEngine::BucketOpenList,
+      ClusterGraph::SparseEntrances, 0 }
+};
+
+enum Topology {
+    RandomTopology, //!< Random single-cell walls of given density.
+    BlocksTopology, //!< Random square blocks of 32x32 cells covering given density of map.
+    MazeTopology,   //!< Perfect maze with corridors of 1 cell; density is ignored.
+    RoomsTopology,  //!< Rooms of 16x16 cells with doors and random walls of given density.
+    SpiralTopology  //!< Concentric rings with one gap each; density is ignored.
+};
+
+const char *const TopologyNames[] = { "random", "blocks", "maze  ", "rooms ", "spiral" };
+
+enum QueryMix {
+    RandomPairs,    //!< Random ball and random empty cell.
+    FarPairs        //!< Ball in top-left quarter and empty cell in bottom-right quarter.
+};
+
+const char *const QueryMixNames[] = { "random", "far   " };
+
+/*!
+    Fills the whole \a gm with walls (\a isWall is true) or empty cells.
+*/
+void fillMap(GameMap &gm, bool isWall)
+{
+    for (int j = 0; j < gm.height(); ++j)
+        for (int i = 0; i < gm.width(); ++i)
+            gm.setWall(i, j, isWall);
+}
+
+/*!
+    Carves perfect maze by randomized depth-first search: cells with odd coordinates are
+    corridor cells, walls between them are removed when search passes through.
+*/
+void generateMaze(GameMap &gm, std::mt19937 &rng)
+{
+    fillMap(gm, true);
+    const int w = (gm.width() - 1) / 2;
+    const int h = (gm.height() - 1) / 2;
+    if (w <= 0 || h <= 0)
+        return;
+
+    static const int dx[] = { -1, 1, 0, 0 };
+    static const int dy[] = { 0, 0, -1, 1 };
+    std::vector<char> visited(std::size_t(w) * h, 0);
+    std::vector<int> stack(1, 0);
+    visited[0] = 1;
+    gm.setWall(1, 1, false);
+    while (!stack.empty()) {
+        const int x = stack.back() % w;
+        const int y = stack.back() / w;
+        int next[4];
+        int count = 0;
+        for (int d = 0; d < 4; ++d) {
+            const int nx = x + dx[d];
+            const int ny = y + dy[d];
+            if (nx >= 0 && nx < w && ny >= 0 && ny < h && !visited[ny * w + nx])
+                next[count++] = d;
+        }
+        if (!count) {
+            stack.pop_back();
+            continue;
+        }
+        const int d = next[std::uniform_int_distribution<int>(0, count - 1)(rng)];
+        const int nx = x + dx[d];
+        const int ny = y + dy[d];
+        visited[ny * w + nx] = 1;
+        gm.setWall(2 * x + 1 + dx[d], 2 * y + 1 + dy[d], false);
+        gm.setWall(2 * nx + 1, 2 * ny + 1, false);
+        stack.push_back(ny * w + nx);
+    }
+}
+
+/*!
+    Splits \a gm into rooms of 16x16 cells separated by walls of 1 cell; every wall between two
+    neighbouring rooms has a door of 2 cells at random position. Rooms are filled with random
+    walls of \a density.
+*/
+void generateRooms(GameMap &gm, double density, std::mt19937 &rng)
+{
+    const int RoomSize = 16;
+    std::bernoulli_distribution isWall(density);
+    std::uniform_int_distribution<int> door(0, RoomSize - 3);
+    for (int j = 0; j < gm.height(); ++j)
+        for (int i = 0; i < gm.width(); ++i)
+            gm.setWall(i, j, i % RoomSize == RoomSize - 1 || j % RoomSize == RoomSize - 1
+                       || isWall(rng));
+
+    for (int top = 0; top < gm.height(); top += RoomSize) {
+        for (int left = 0; left < gm.width(); left += RoomSize) {
+            const int right = left + RoomSize - 1;
+            const int bottom = top + RoomSize - 1;
+            if (right < gm.width()) {
+                const int y = top + door(rng);
+                for (int j = y; j < y + 2 && j < gm.height(); ++j)
+                    gm.setWall(right, j, false);
+            }
+            if (bottom < gm.height()) {
+                const int x = left + door(rng);
+                for (int i = x; i < x + 2 && i < gm.width(); ++i)
+                    gm.setWall(i, bottom, false);
+            }
+        }
+    }
+}
+
+/*!
+    Draws concentric square rings of walls every 2 cells; every ring has one gap at random
+    position of its top side (for even rings) or bottom side (for odd rings), so that path to
+    the center winds around all the rings.
+*/
+void generateSpiral(GameMap &gm, std::mt19937 &rng)
+{
+    fillMap(gm, false);
+    for (int k = 0; ; ++k) {
+        const int left = 2 * k + 1;
+        const int top = 2 * k + 1;
+        const int right = gm.width() - 2 - 2 * k;
+        const int bottom = gm.height() - 2 - 2 * k;
+        if (right - left < 2 || bottom - top < 2)
+            break;
+        for (int i = left; i <= right; ++i) {
+            gm.setWall(i, top, true);
+            gm.setWall(i, bottom, true);
+        }
+        for (int j = top; j <= bottom; ++j) {
+            gm.setWall(left, j, true);
+            gm.setWall(right, j, true);
+        }
+        const int gap = std::uniform_int_distribution<int>(left + 1, right - 1)(rng);
+        gm.setWall(gap, k % 2 ? bottom : top, false);
+    }
+}
+
+/*!
+    Fills \a gm with walls of \a topology; see Topology for meaning of \a density.
+*/
+void generateMap(GameMap &gm, double density, std::mt19937 &rng,
+                 Topology topology = RandomTopology)
+{
+    switch (topology) {
+        case RandomTopology: {
+            std::bernoulli_distribution isWall(density);
+            for (int j = 0; j < gm.height(); ++j)
+                for (int i = 0; i < gm.width(); ++i)
+                    gm.setWall(i, j, isWall(rng));
+            return;
+        }
+        case MazeTopology:
+            generateMaze(gm, rng);
+            return;
+        case RoomsTopology:
+            generateRooms(gm, density, rng);
+            return;
+        case SpiralTopology:
+            generateSpiral(gm, rng);
+            return;
+        case BlocksTopology:
+            break;
+    }
+
+    const int BlockSize = 32;
+    fillMap(gm, false);
+    std::uniform_int_distribution<int> x(0, gm.width() - 1);
+    std::uniform_int_distribution<int> y(0, gm.height() - 1);
+    const int count = static_cast<int>(density * gm.width() * gm.height()
+                                       / (BlockSize * BlockSize));
+    for (int k = 0; k < count; ++k) {
+        const int left = x(rng);
+        const int top = y(rng);
+        for (int j = top; j < top + BlockSize && j < gm.height(); ++j)
+            for (int i = left; i < left + BlockSize && i < gm.width(); ++i)
+                gm.setWall(i, j, true);
+    }
+}
+
+/*!
+    Returns random point of \a gm which is wall if \a wall is true or empty otherwise; point
+    is taken from rectangle [\a left, \a right] x [\a top, \a bottom] (the whole map by
+    default). Returns null point if there is no such point in rectangle.
+*/
+Point randomCell(const GameMap &gm, bool wall, std::mt19937 &rng, int left = 0, int top = 0,
+                 int right = -1, int bottom = -1)
+{
+    if (right < 0)
+        right = gm.width() - 1;
+    if (bottom < 0)
+        bottom = gm.height() - 1;
+    std::uniform_int_distribution<int> x(left, right);
+    std::uniform_int_distribution<int> y(top, bottom);
+    for (int attempt = 0; attempt < 1000000; ++attempt) {
+        Point p(x(rng), y(rng));
+        if (gm.isWall(p) == wall)
+            return p;
+    }
+    for (int j = top; j <= bottom; ++j)
+        for (int i = left; i <= right; ++i)
+            if (gm.isWall(i, j) == wall)
+                return Point(i, j);
+    return Point(-1, -1);
+}
+
+/*!
+    Returns random query of query \a mix at \a gm.
+*/
+Query randomQuery(const GameMap &gm, QueryMix mix, std::mt19937 &rng)
+{
+    if (mix == RandomPairs)
+        return Query(randomCell(gm, true, rng), randomCell(gm, false, rng));
+
+    const int w = gm.width();
+    const int h = gm.height();
+    return Query(randomCell(gm, true, rng, 0, 0, (w - 1) / 4, (h - 1) / 4),
+                 randomCell(gm, false, rng, w - 1 - (w - 1) / 4, h - 1 - (h - 1) / 4));
+}
+
+/*!
+    Returns peak resident set size of process in megabytes (0 if it's unknown).
+*/
+double peakMemoryMb()
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+#  if defined(__APPLE__)
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#  else
+    return usage.ru_maxrss / 1024.0;
+#  endif
+#endif
+}
+
+/*!
+    Returns \a p-th percentile (0..1) of \a values in microseconds; reorders \a values.
+*/
+double percentileUsecs(std::vector<Clock::duration> &values, double p)
+{
+    std::size_t n = static_cast<std::size_t>(p * (values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + n, values.end());
+    return std::chrono::duration<double, std::micro>(values[n]).count();
+}
+
+/*!
+    Runs \a queries path queries of query \a mix on map \a size x \a size of \a topology
+    and prints results; see Topology for meaning of \a density.
+*/
+void run(int size, Topology topology, double density, QueryMix mix, int queries,
+         const Engine &engine, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    GameMap gm(size, size);
+    generateMap(gm, density, rng, topology);
+
+    // Abstract graph and landmark tables are built once per map, so they're timed separately
+    // from queries
+    Clock::duration clustersTime = Clock::duration::zero();
+    if (engine.algorithm == PathFinder::Hierarchical) {
+        Clock::time_point t0 = Clock::now();
+        gm.buildClusters(ClusterSize, engine.entranceMode);
+        clustersTime = Clock::now() - t0;
+    }
+    Clock::duration landmarksTime = Clock::duration::zero();
+    if (engine.landmarkCount > 0) {
+        Clock::time_point t0 = Clock::now();
+        gm.buildLandmarks(engine.landmarkCount);
+        landmarksTime = Clock::now() - t0;
+    }
+
+    long long expanded = 0;
+    std::vector<Clock::duration> latencies;
+    latencies.reserve(queries);
+    PathFinder finder(&gm, 0, engine.openListType);
+    finder.setAlgorithm(engine.algorithm);
+    PathFinder reference(&gm);
+    reference.setAlgorithm(PathFinder::AStar);
+    int checkedPaths = 0;
+    int longerPaths = 0;
+    double ratioSum = 0;
+    double maxRatio = 1;
+    for (int q = 0; q < queries; ++q) {
+        Query query = randomQuery(gm, mix, rng);
+        if (query.start.x() < 0 || query.finish.x() < 0)
+            continue;
+        Clock::time_point t0 = Clock::now();
+        finder.findPath(query.start, query.finish);
+        latencies.push_back(Clock::now() - t0);
+        expanded += finder.expandedCount();
+
+        if (engine.algorithm == PathFinder::Hierarchical && !finder.path().empty()
+                && reference.findPath(query.start, query.finish)) {
+            ++checkedPaths;
+            if (finder.path().length() > reference.path().length()) {
+                const double ratio = double(finder.path().length()) / reference.path().length();
+                ++longerPaths;
+                ratioSum += ratio;
+                maxRatio = std::max(maxRatio, ratio);
+            }
+        }
+    }
+    if (latencies.empty())
+        return;
+    std::size_t scratchBytes = finder.memoryUsage();
+
+    Clock::duration elapsed = Clock::duration::zero();
+    for (Clock::duration latency : latencies)
+        elapsed += latency;
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double area = double(size) * size;
+    std::cout << std::setw(5) << size << 'x' << std::left << std::setw(5) << size << std::right
+              << "  " << engine.name
+              << "  " << TopologyNames[topology]
+              << "  density " << std::fixed << std::setprecision(2) << density
+              << "  " << QueryMixNames[mix]
+              << "  map " << std::setw(5)
+              << gm.memoryUsage() / area << " B/cell"
+              << "  scratch " << std::setw(5) << scratchBytes / area << " B/cell"
+              << std::setprecision(1)
+              << "  median " << std::setw(9) << percentileUsecs(latencies, 0.5) << " us"
+              << "  p99 " << std::setw(9) << percentileUsecs(latencies, 0.99) << " us"
+              << std::setprecision(0)
+              << "  " << std::setw(10) << expanded / seconds << " expanded/s"
+              << "  peak " << std::setw(5) << peakMemoryMb() << " MB";
+    if (gm.clusters()) {
+        double clustersMsecs = std::chrono::duration<double, std::milli>(clustersTime).count();
+        std::cout << std::setprecision(1) << "  clusters " << clustersMsecs << " ms "
+                  << std::setprecision(2) << gm.clusters()->memoryUsage() / area << " B/cell";
+    }
+    if (checkedPaths) {
+        std::cout << std::setprecision(1) << "  longer " << 100.0 * longerPaths / checkedPaths
+                  << "% (mean " << std::setprecision(2)
+                  << (longerPaths ? ratioSum / longerPaths : 1.0) << ", max " << maxRatio << ')';
+    }
+    if (gm.landmarks()) {
+        double landmarksMsecs = std::chrono::duration<double, std::milli>(landmarksTime).count();
+        std::cout << std::setprecision(1) << "  landmarks " << landmarksMsecs << " ms "
+                  << std::setprecision(2) << gm.landmarks()->memoryUsage() / area << " B/cell";
+    }
+    std::cout << std::endl;
+    std::cout.unsetf(std::ios_base::floatfield);
+}
+
+/*!
+    Generates all the legal moves at \a maps random maps \a size x \a size with MoveGenerator
+    and with path search per (ball, empty cell) pair, and prints throughput of both.
+*/
+void runMoves(int size, double density, int maps, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    GameMap gm(size, size);
+    MoveGenerator generator(&gm);
+    PathFinder finder(&gm);
+
+    long long moves = 0;
+    long long searchedMoves = 0;
+    Clock::duration generatorTime = Clock::duration::zero();
+    Clock::duration searchTime = Clock::duration::zero();
+    for (int m = 0; m < maps; ++m) {
+        generateMap(gm, density, rng);
+
+        Clock::time_point t0 = Clock::now();
+        generator.generate();
+        for (const BallMoves &ballMoves : generator.moves())
+            moves += ballMoves.targetCount;
+        generatorTime += Clock::now() - t0;
+
+        t0 = Clock::now();
+        for (const BallMoves &ballMoves : generator.moves()) {
+            for (int j = 0; j < size; ++j) {
+                for (int i = 0; i < size; ++i) {
+                    if (gm.isWall(i, j))
+                        continue;
+                    finder.findPath(ballMoves.ball, Point(i, j));
+                    if (!finder.path().empty())
+                        ++searchedMoves;
+                }
+            }
+        }
+        searchTime += Clock::now() - t0;
+    }
+
+    double generatorSeconds = std::chrono::duration<double>(generatorTime).count();
+    double searchSeconds = std::chrono::duration<double>(searchTime).count();
+    std::cout << std::setw(5) << size << 'x' << std::left << std::setw(5) << size << std::right
+              << "  moves " << moves << (moves == searchedMoves ? "" : " (MISMATCH)")
+              << "  generator " << std::setw(8) << std::fixed << std::setprecision(0)
+              << maps / generatorSeconds << " maps/s"
+              << "  search per pair " << std::setw(8) << maps / searchSeconds << " maps/s"
+              << std::endl;
+    std::cout.unsetf(std::ios_base::floatfield);
+}
+
+/*!
+    Plays \a turns random game turns on map \a size x \a size twice: with components labelling
+    updated incrementally and rebuilt after every turn, and prints throughput of both.
+*/
+void runTurns(int size, double density, int turns, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    GameMap gm(size, size);
+    generateMap(gm, density, rng);
+
+    // Every turn takes 8 points: ball and target of move, 3 spawned balls, 3 cleared balls
+    GameMap scratch = gm;
+    std::vector<Point> ops;
+    for (int t = 0; t < turns; ++t) {
+        ops.push_back(randomCell(scratch, true, rng));
+        ops.push_back(randomCell(scratch, false, rng));
+        scratch.moveBall(ops[ops.size() - 2], ops.back());
+        for (int i = 0; i < 3; ++i) {
+            ops.push_back(randomCell(scratch, false, rng));
+            scratch.placeBall(ops.back());
+        }
+        for (int i = 0; i < 3; ++i) {
+            ops.push_back(randomCell(scratch, true, rng));
+            scratch.removeBall(ops.back());
+        }
+    }
+
+    double seconds[2];
+    int components[2];
+    for (int incremental = 1; incremental >= 0; --incremental) {
+        GameMap map = gm;
+        map.buildComponents();
+        Clock::time_point t0 = Clock::now();
+        for (std::size_t i = 0; i < ops.size(); i += 8) {
+            if (!incremental)
+                map.clearComponents();
+            map.moveBall(ops[i], ops[i + 1]);
+            for (int j = 2; j < 8; ++j) {
+                if (j < 5)
+                    map.placeBall(ops[i + j]);
+                else
+                    map.removeBall(ops[i + j]);
+            }
+            if (!incremental)
+                map.buildComponents();
+        }
+        seconds[incremental] = std::chrono::duration<double>(Clock::now() - t0).count();
+        components[incremental] = map.components()->componentCount();
+    }
+
+    std::cout << std::setw(5) << size << 'x' << std::left << std::setw(5) << size << std::right
+              << "  components " << components[1]
+              << (components[0] == components[1] ? "" : " (MISMATCH)")
+              << "  incremental " << std::setw(9) << std::fixed << std::setprecision(0)
+              << turns / seconds[1] << " turns/s"
+              << "  rebuild " << std::setw(9) << turns / seconds[0] << " turns/s" << std::endl;
+    std::cout.unsetf(std::ios_base::floatfield);
+}
+
+/*!
+    Applies \a mutations random changes (wall set or cleared, ball moved) to game map \a width
+    x \a height with walls of \a density and components labelling updated incrementally; after
+    every change compares ComponentIndex::isReachable() of all the pairs of cells with labelling
+    rebuilt from scratch. Prints the first mismatch.
+    \return false if labellings differ.
+*/
+bool checkComponents(int width, int height, double density, int mutations, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    GameMap gm(width, height);
+    generateMap(gm, density, rng);
+    gm.buildComponents();
+
+    std::uniform_int_distribution<int> x(0, width - 1);
+    std::uniform_int_distribution<int> y(0, height - 1);
+    std::uniform_int_distribution<int> kind(0, 2);
+    for (int m = 0; m < mutations; ++m) {
+        const Point p(x(rng), y(rng));
+        if (kind(rng) < 2) {
+            gm.setWall(p, !gm.isWall(p));
+        } else {
+            const Point target(x(rng), y(rng));
+            if (gm.isWall(p) && !gm.isWall(target))
+                gm.moveBall(p, target);
+        }
+
+        ComponentIndex rebuilt;
+        rebuilt.build(gm);
+        const ComponentIndex *incremental = gm.components();
+        bool isMatch = incremental->componentCount() == rebuilt.componentCount();
+        for (int j1 = 0; j1 < height && isMatch; ++j1) {
+            for (int i1 = 0; i1 < width && isMatch; ++i1) {
+                const int start = gm.index(i1, j1);
+                for (int j2 = 0; j2 < height && isMatch; ++j2) {
+                    for (int i2 = 0; i2 < width && isMatch; ++i2) {
+                        const int finish = gm.index(i2, j2);
+                        isMatch = incremental->isReachable(start, finish)
+                                == rebuilt.isReachable(start, finish);
+                    }
+                }
+            }
+        }
+        if (!isMatch) {
+            std::cout << width << 'x' << height << "  density " << density << "  seed " << seed
+                      << "  MISMATCH after change " << m + 1 << " at (" << p.x() << ','
+                      << p.y() << ')' << std::endl;
+            return false;
+        }
+    }
+    std::cout << std::setw(5) << width << 'x' << std::left << std::setw(5) << height
+              << std::right << "  density " << std::setw(4) << density << "  changes "
+              << mutations << "  ok" << std::endl;
+    return true;
+}
+
+/*!
+    Runs batch of \a queries path queries on map \a size x \a size with 1..\a maxThreads
+    threads and prints throughput.
+*/
+void runScaling(int size, double density, int queries, int maxThreads, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    GameMap gm(size, size);
+    generateMap(gm, density, rng);
+
+    std::vector<Query> batch;
+    for (int q = 0; q < queries; ++q)
+        batch.push_back(Query(randomCell(gm, true, rng), randomCell(gm, false, rng)));
+
+    for (int threads = 1; threads <= maxThreads; ++threads) {
+        std::vector<PathFinder *> finders;
+        for (int i = 0; i < threads; ++i)
+            finders.push_back(new PathFinder(&gm));
+
+        Clock::time_point t0 = Clock::now();
+        {
+            ThreadPool pool(threads);
+            for (int q = 0; q < queries; ++q) {
+                pool.submit(q * threads / queries, [&, q](int worker) {
+                    finders[worker]->findPath(batch[q].start, batch[q].finish);
+                });
+            }
+            pool.wait();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+        std::cout << std::setw(5) << size << 'x' << std::left << std::setw(5) << size << std::right
+                  << "  threads " << std::setw(3) << threads
+                  << "  " << std::setw(8) << std::fixed << std::setprecision(0)
+                  << queries / seconds << " queries/s" << std::endl;
+        std::cout.unsetf(std::ios_base::floatfield);
+
+        for (auto finder : finders)
+            delete finder;
+    }
+}
+
+/*!
+    Parses decimal number \a text into \a value which must not exceed \a limit.
+    \return false if \a text isn't such number.
+*/
+bool parseNumber(const char *text, unsigned long limit, unsigned long &value)
+{
+    if (!std::isdigit(static_cast<unsigned char>(*text)))
+        return false;
+    char *end = 0;
+    errno = 0;
+    value = std::strtoul(text, &end, 10);
+    return !*end && !errno && value <= limit;
+}
+
+/*!
+    Prints out usage of benchmark.
+*/
+void printUsage()
+{
+    std::cout << "Usage: ./ballpath-bench [seed [max_threads]]" << std::endl;
+    std::cout << "       ./ballpath-bench --check [seed]" << std::endl;
+    std::cout << "  seed         non-negative number of random generator (default is 1)"
+              << std::endl;
+    std::cout << "  max_threads  positive count of threads for scaling runs" << std::endl;
+    std::cout << "  --check      compare incremental components labelling with rebuilt one"
+              << std::endl;
+}
+
+} // anonymous namespace
+
+/*!
+    Entry point.
+*/
+int main(int argc, char *argv[])
+{
+    const bool isCheck = argc > 1 && !std::strcmp(argv[1], "--check");
+    const int first = isCheck ? 2 : 1; // index of seed argument
+    unsigned long seed = 1;
+    unsigned long maxThreads = ThreadPool::idealThreadCount();
+    if (argc > first + (isCheck ? 1 : 2)
+            || (argc > first && !parseNumber(argv[first], UINT_MAX, seed))
+            || (!isCheck && argc > first + 1
+                && (!parseNumber(argv[first + 1], INT_MAX, maxThreads) || maxThreads == 0))) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    if (isCheck) {
+        const int sizes[][2] = { {1, 1}, {1, 9}, {9, 1}, {2, 2}, {3, 5}, {9, 9}, {16, 16},
+                                 {31, 7} };
+        const double densities[] = { 0.2, 0.45, 0.6 };
+        bool isOk = true;
+        for (const auto &size : sizes) {
+            for (double density : densities)
+                isOk = checkComponents(size[0], size[1], density, 500, seed) && isOk;
+        }
+        return isOk ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    for (const Engine &engine : Engines) {
+        run(9, RandomTopology, 0.3, RandomPairs, 100000, engine, seed);
+        if (engine.algorithm == PathFinder::Auto)
+            continue; // the same as astar-bucket for other sizes
+        run(64, RandomTopology, 0.3, RandomPairs, 10000, engine, seed);
+        run(256, RandomTopology, 0.3, RandomPairs, 500, engine, seed);
+        run(256, RandomTopology, 0.45, RandomPairs, 500, engine, seed);
+        run(256, MazeTopology, 0, FarPairs, 200, engine, seed);
+        run(256, RoomsTopology, 0.1, FarPairs, 200, engine, seed);
+        run(256, SpiralTopology, 0, FarPairs, 200, engine, seed);
+        run(1024, RandomTopology, 0.3, RandomPairs, 50, engine, seed);
+        run(1024, RandomTopology, 0.3, FarPairs, 50, engine, seed);
+        run(1024, RandomTopology, 0.45, RandomPairs, 50, engine, seed);
+        run(1024, RandomTopology, 0.05, RandomPairs, 50, engine, seed);
+        run(1024, BlocksTopology, 0.2, RandomPairs, 50, engine, seed);
+        run(1024, MazeTopology, 0, FarPairs, 10, engine, seed);
+        run(1024, RoomsTopology, 0.1, FarPairs, 20, engine, seed);
+        run(2048, RandomTopology, 0.2, RandomPairs, 10, engine, seed);
+        run(4096, RandomTopology, 0.2, FarPairs, 3, engine, seed);
+    }
+
+    runMoves(9, 0.3, 2000, seed);
+    runMoves(24, 0.3, 20, seed);
+
+    runTurns(9, 0.3, 100000, seed);
+    runTurns(256, 0.3, 2000, seed);
+
+    runScaling(256, 0.3, 4000, static_cast<int>(maxThreads), seed);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,292 @@
+#include <new>
+#include <vector>
+#include "api/ballpath.h"
+#include "inputreader.h"
+#include "core/gamemap.h"
+#include "core/pathfinder.h"
+#include "util/rowparser.h"
+
+/*
+    Implementation of plain C API (see ballpath.h) on top of GameMap and PathFinder. No C++
+    exception leaves these functions: allocation failures are reported as null handles or
+    BALLPATH_OUT_OF_MEMORY.
+*/
+
+struct ballpath_map
+{
+    GameMap gameMap;
+};
+
+struct ballpath_finder
+{
+    explicit ballpath_finder(const GameMap *gameMap)
+        : map(gameMap), finder(gameMap)
+    {
+    }
+
+    const GameMap *map;
+    PathFinder finder;
+};
+
+namespace {
+
+const char MoveChars[] = { '?', 'L', 'R', 'U', 'D', 'F' }; // indexed by Action::Type
+
+bool isInside(const GameMap &gameMap, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < gameMap.width() && y < gameMap.height();
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+/*!
+    Returns BALLPATH_API_VERSION library was built with; compare it to the one of header to
+    detect mismatched shared library.
+*/
+int ballpath_api_version(void)
+{
+    return BALLPATH_API_VERSION;
+}
+
+/*!
+    Creates empty game map of \a width x \a height cells.
+    \return null if size isn't positive or memory can't be allocated.
+*/
+ballpath_map *ballpath_map_create(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return 0;
+    try {
+        ballpath_map *map = new ballpath_map;
+        map->gameMap.resize(Size(width, height));
+        return map;
+    } catch (const std::bad_alloc &) {
+        return 0;
+    }
+}
+
+/*!
+    Creates game map of \a width x \a height cells from \a cells buffer: each row is \a width
+    characters '0' (empty cell) or '1' (ball), rows start every \a stride bytes.
+    \return null if arguments are invalid, buffer contains another character or memory can't
+    be allocated.
+*/
+ballpath_map *ballpath_map_create_from_buffer(const char *cells, int width, int height,
+                                              size_t stride)
+{
+    if (!cells || stride < static_cast<size_t>(width))
+        return 0;
+    ballpath_map *map = ballpath_map_create(width, height);
+    if (!map)
+        return 0;
+
+    try {
+        std::vector<std::uint64_t> freeBits(map->gameMap.rowWords());
+        for (int y = 0; y < height; ++y) {
+            if (RowParser::parse(cells + y * stride, width, freeBits.data()) != width) {
+                delete map;
+                return 0;
+            }
+            map->gameMap.setRow(y, freeBits.data());
+        }
+    } catch (const std::bad_alloc &) {
+        delete map;
+        return 0;
+    }
+    return map;
+}
+
+/*!
+    Loads game map from text or binary file \a file_path (see InputReader); queries of file
+    are ignored.
+    \return null if file can't be read.
+*/
+ballpath_map *ballpath_map_load(const char *file_path)
+{
+    if (!file_path)
+        return 0;
+    try {
+        InputReader reader;
+        if (!reader.read(file_path))
+            return 0;
+        ballpath_map *map = new ballpath_map;
+        map->gameMap = *reader.gameMap();
+        return map;
+    } catch (const std::bad_alloc &) {
+        return 0;
+    }
+}
+
+/*!
+    Frees \a map; null is allowed. Finders of the map must be freed first.
+*/
+void ballpath_map_free(ballpath_map *map)
+{
+    delete map;
+}
+
+/*!
+    Returns width of \a map or 0 if \a map is null.
+*/
+int ballpath_map_width(const ballpath_map *map)
+{
+    return map ? map->gameMap.width() : 0;
+}
+
+/*!
+    Returns height of \a map or 0 if \a map is null.
+*/
+int ballpath_map_height(const ballpath_map *map)
+{
+    return map ? map->gameMap.height() : 0;
+}
+
+/*!
+    Places ball to (\a x, \a y) cell of \a map if \a is_wall is non-zero, otherwise makes the
+    cell empty. Labelling of connected components (if built) is kept up to date.
+*/
+int ballpath_map_set_wall(ballpath_map *map, int x, int y, int is_wall)
+{
+    if (!map || !isInside(map->gameMap, x, y))
+        return BALLPATH_INVALID_ARGUMENT;
+    try {
+        map->gameMap.setWall(x, y, is_wall != 0);
+    } catch (const std::bad_alloc &) {
+        return BALLPATH_OUT_OF_MEMORY;
+    }
+    return BALLPATH_OK;
+}
+
+/*!
+    Returns 1 if (\a x, \a y) cell of \a map is a ball, 0 if it's empty and -1 if arguments
+    are invalid.
+*/
+int ballpath_map_is_wall(const ballpath_map *map, int x, int y)
+{
+    if (!map || !isInside(map->gameMap, x, y))
+        return -1;
+    return map->gameMap.isWall(x, y) ? 1 : 0;
+}
+
+/*!
+    Labels connected components of \a map, so that queries to unreachable cells are rejected
+    without search (see GameMap::buildComponents()).
+*/
+int ballpath_map_build_components(ballpath_map *map)
+{
+    if (!map)
+        return BALLPATH_INVALID_ARGUMENT;
+    try {
+        map->gameMap.buildComponents();
+    } catch (const std::bad_alloc &) {
+        return BALLPATH_OUT_OF_MEMORY;
+    }
+    return BALLPATH_OK;
+}
+
+/*!
+    Builds abstract graph of \a map with clusters of \a cluster_size x \a cluster_size cells
+    for BALLPATH_ALGORITHM_HIERARCHICAL; if \a optimal is non-zero, entrance is placed at every
+    border cell, so that paths are exactly the shortest ones (see GameMap::buildClusters()).
+    Any change of map by ballpath_map_set_wall() drops the graph.
+*/
+int ballpath_map_build_clusters(ballpath_map *map, int cluster_size, int optimal)
+{
+    if (!map || cluster_size < 2)
+        return BALLPATH_INVALID_ARGUMENT;
+    try {
+        map->gameMap.buildClusters(cluster_size, optimal ? ClusterGraph::AllEntrances
+                                                         : ClusterGraph::SparseEntrances);
+    } catch (const std::bad_alloc &) {
+        return BALLPATH_OUT_OF_MEMORY;
+    }
+    return BALLPATH_OK;
+}
+
+/*!
+    Builds distance tables of \a count landmarks (1..64) of \a map for heuristic of
+    BALLPATH_ALGORITHM_ASTAR (and BALLPATH_ALGORITHM_AUTO on maps other than 9x9); landmarks
+    are random empty cells if \a random is non-zero and the farthest ones from each other
+    otherwise (see GameMap::buildLandmarks()). Tables take 2 * \a count bytes per cell. Any
+    change of map by ballpath_map_set_wall() drops them.
+*/
+int ballpath_map_build_landmarks(ballpath_map *map, int count, int random)
+{
+    if (!map || count < 1 || count > LandmarkIndex::MaxLandmarks)
+        return BALLPATH_INVALID_ARGUMENT;
+    try {
+        map->gameMap.buildLandmarks(count, random ? LandmarkIndex::RandomLandmarks
+                                                  : LandmarkIndex::FarthestLandmarks);
+    } catch (const std::bad_alloc &) {
+        return BALLPATH_OUT_OF_MEMORY;
+    }
+    return BALLPATH_OK;
+}
+
+/*!
+    Creates path finder for \a map using \a algorithm (one of BALLPATH_ALGORITHM_*). Finder
+    keeps its search scratch between queries, so reuse it for many queries.
+    \return null if arguments are invalid or memory can't be allocated.
+*/
+ballpath_finder *ballpath_finder_create(const ballpath_map *map, int algorithm)
+{
+    if (!map || algorithm < BALLPATH_ALGORITHM_AUTO
+            || algorithm > BALLPATH_ALGORITHM_HIERARCHICAL)
+        return 0;
+    try {
+        ballpath_finder *finder = new ballpath_finder(&map->gameMap);
+        finder->finder.setAlgorithm(static_cast<PathFinder::Algorithm>(algorithm));
+        return finder;
+    } catch (const std::bad_alloc &) {
+        return 0;
+    }
+}
+
+/*!
+    Frees \a finder; null is allowed.
+*/
+void ballpath_finder_free(ballpath_finder *finder)
+{
+    delete finder;
+}
+
+/*!
+    Finds the shortest path for ball at (\a start_x, \a start_y) to empty cell (\a finish_x,
+    \a finish_y). On success writes moves of path to \a moves (null-terminated, so
+    \a capacity must be at least path length + 1) and path length to \a length (if not null).
+    If \a moves is too small, BALLPATH_BUFFER_TOO_SMALL is returned and \a length is still
+    set, so caller can retry with buffer of required size.
+*/
+int ballpath_find_path(ballpath_finder *finder, int start_x, int start_y, int finish_x,
+                       int finish_y, char *moves, size_t capacity, size_t *length)
+{
+    if (length)
+        *length = 0;
+    if (!finder || !isInside(*finder->map, start_x, start_y)
+            || !isInside(*finder->map, finish_x, finish_y)
+            || !finder->map->isWall(start_x, start_y)
+            || finder->map->isWall(finish_x, finish_y))
+        return BALLPATH_INVALID_ARGUMENT;
+
+    try {
+        if (!finder->finder.findPath(Point(start_x, start_y), Point(finish_x, finish_y)))
+            return BALLPATH_NO_PATH;
+    } catch (const std::bad_alloc &) {
+        return BALLPATH_OUT_OF_MEMORY;
+    }
+
+    const Path &path = finder->finder.path();
+    const size_t count = path.length();
+    if (length)
+        *length = count;
+    if (!moves || capacity < count + 1)
+        return BALLPATH_BUFFER_TOO_SMALL;
+    for (size_t i = 0; i < count; ++i)
+        moves[i] = MoveChars[path.move(i)];
+    moves[count] = '\0';
+    return BALLPATH_OK;
+}
+
+} // extern "C"
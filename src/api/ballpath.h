@@ -0,0 +1,87 @@
+#ifndef BALLPATH_H
+#define BALLPATH_H
+
+/*
+    Plain C API of libballpath.
+
+    Game map cells are addressed in row order: x is column (0..width-1) and y is row
+    (0..height-1) counting from the first row of buffer, so that (0, 0) is the first cell of
+    buffer passed to ballpath_map_create_from_buffer(). Path is returned as string of moves
+    'L', 'R', 'U', 'D' (decreasing x, increasing x, decreasing y, increasing y).
+
+    Functions returning int return one of BALLPATH_* status codes. Map must outlive all
+    finders created for it; map can be changed between queries of its finders, but neither
+    map nor finder may be used from different threads at the same time.
+*/
+
+#include <stddef.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#   if defined(BALLPATH_SHARED_LIB) && defined(BALLPATH_BUILDING_LIB)
+#       define BALLPATH_API __declspec(dllexport)
+#   elif defined(BALLPATH_SHARED_LIB)
+#       define BALLPATH_API __declspec(dllimport)
+#   else
+#       define BALLPATH_API
+#   endif
+#elif defined(__GNUC__)
+#   define BALLPATH_API __attribute__((visibility("default")))
+#else
+#   define BALLPATH_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BALLPATH_API_VERSION 1
+
+typedef struct ballpath_map ballpath_map;
+typedef struct ballpath_finder ballpath_finder;
+
+enum {
+    BALLPATH_OK = 0,
+    BALLPATH_NO_PATH = 1,           /* finish point isn't reachable */
+    BALLPATH_INVALID_ARGUMENT = 2,  /* null pointer, point out of map, start isn't a ball... */
+    BALLPATH_BUFFER_TOO_SMALL = 3,  /* path doesn't fit to moves buffer */
+    BALLPATH_OUT_OF_MEMORY = 4
+};
+
+/* Mirrors PathFinder::Algorithm */
+enum {
+    BALLPATH_ALGORITHM_AUTO = 0,
+    BALLPATH_ALGORITHM_ASTAR = 1,
+    BALLPATH_ALGORITHM_BIDIRECTIONAL_ASTAR = 2,
+    BALLPATH_ALGORITHM_BFS = 3,
+    BALLPATH_ALGORITHM_JPS = 4,
+    BALLPATH_ALGORITHM_HIERARCHICAL = 5 /* needs ballpath_map_build_clusters(), A* otherwise */
+};
+
+BALLPATH_API int ballpath_api_version(void);
+
+BALLPATH_API ballpath_map *ballpath_map_create(int width, int height);
+BALLPATH_API ballpath_map *ballpath_map_create_from_buffer(const char *cells, int width,
+                                                           int height, size_t stride);
+BALLPATH_API ballpath_map *ballpath_map_load(const char *file_path);
+BALLPATH_API void ballpath_map_free(ballpath_map *map);
+
+BALLPATH_API int ballpath_map_width(const ballpath_map *map);
+BALLPATH_API int ballpath_map_height(const ballpath_map *map);
+BALLPATH_API int ballpath_map_set_wall(ballpath_map *map, int x, int y, int is_wall);
+BALLPATH_API int ballpath_map_is_wall(const ballpath_map *map, int x, int y);
+BALLPATH_API int ballpath_map_build_components(ballpath_map *map);
+BALLPATH_API int ballpath_map_build_clusters(ballpath_map *map, int cluster_size, int optimal);
+BALLPATH_API int ballpath_map_build_landmarks(ballpath_map *map, int count, int random);
+
+BALLPATH_API ballpath_finder *ballpath_finder_create(const ballpath_map *map, int algorithm);
+BALLPATH_API void ballpath_finder_free(ballpath_finder *finder);
+
+BALLPATH_API int ballpath_find_path(ballpath_finder *finder, int start_x, int start_y,
+                                    int finish_x, int finish_y, char *moves, size_t capacity,
+                                    size_t *length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BALLPATH_H */
@@ -1,8 +1,24 @@
+#include <chrono>
 #include <iostream>
 #include "appcontroller.h"
 #include "inputreader.h"
-#include "resultwriter.h"
+#include "session.h"
+#include "socketserver.h"
 #include "core/pathfinder.h"
+#include "util/math.h"
+#include "util/threadpool.h"
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    /*!
+        Returns duration \a d in milliseconds.
+    */
+    double toMsecs(Clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+} // anonymous namespace
 
 /*!
     \class AppController
@@ -10,44 +26,538 @@
 */
 
 AppController::AppController()
+    : m_batchMode(false), m_threadCount(ThreadPool::idealThreadCount()),
+      m_algorithm(PathFinder::Auto), m_componentsEnabled(false), m_clusterSize(16),
+      m_entranceMode(ClusterGraph::SparseEntrances), m_landmarkCount(0),
+      m_selectionMode(LandmarkIndex::FarthestLandmarks),
+      m_outputFormat(ResultWriter::TextFormat), m_statsEnabled(false),
+      m_serveMode(false)
+{
+}
+
+/*!
+    Enables batch mode if \a enabled is true: all the queries from input file are performed
+    against one loaded game map and one result line is written per query.
+    \sa InputReader, ResultWriter
+*/
+void AppController::setBatchMode(bool enabled)
+{
+    m_batchMode = enabled;
+}
+
+/*!
+    Sets count of threads used for solving queries in batch mode to \a count;
+    by default all the hardware threads are used.
+*/
+void AppController::setThreadCount(int count)
+{
+    m_threadCount = Math::max(count, 1);
+}
+
+/*!
+    Selects search \a algorithm; by default PathFinder::Auto is used.
+    \sa PathFinder
+*/
+void AppController::setAlgorithm(PathFinder::Algorithm algorithm)
+{
+    m_algorithm = algorithm;
+}
+
+/*!
+    Enables labelling of connected components of game map at load time if \a enabled is true,
+    so queries with unreachable finish point are answered without search.
+    \sa GameMap::buildComponents()
+*/
+void AppController::setComponentsEnabled(bool enabled)
+{
+    m_componentsEnabled = enabled;
+}
+
+/*!
+    Sets size of cluster side (\a clusterSize cells, 16 by default) and entrances \a mode
+    (ClusterGraph::SparseEntrances by default) of abstract graph for PathFinder::Hierarchical
+    algorithm. Abstract graph is built at load time only if this algorithm is selected.
+    \sa GameMap::buildClusters()
+*/
+void AppController::setClusterSize(int clusterSize, ClusterGraph::EntranceMode mode)
+{
+    m_clusterSize = Math::max(clusterSize, 2);
+    m_entranceMode = mode;
+}
+
+/*!
+    Sets count of landmarks (\a count, 0 by default, i.e. landmarks aren't used) and their
+    selection \a mode (LandmarkIndex::FarthestLandmarks by default) for A* heuristic. Landmark
+    tables are built (or loaded from binary map file) at load time only if selected algorithm
+    uses them (PathFinder::AStar and PathFinder::Auto).
+    \sa GameMap::buildLandmarks()
+*/
+void AppController::setLandmarkCount(int count, LandmarkIndex::SelectionMode mode)
+{
+    m_landmarkCount = Math::max(count, 0);
+    m_selectionMode = mode;
+}
+
+/*!
+    Sets \a format of results; by default ResultWriter::TextFormat is used.
+    \sa ResultWriter
+*/
+void AppController::setOutputFormat(ResultWriter::Format format)
+{
+    m_outputFormat = format;
+}
+
+/*!
+    Enables writing of statistics of run to error stream if \a enabled is true: time of
+    parsing input, building search structures with count of components and memory of their
+    labelling (see setComponentsEnabled()), building abstract
+    graph and landmark tables with their memory (see setClusterSize() and
+    setLandmarkCount()), searching and writing results, and search counters (see
+    SearchStats). For PathFinder::Hierarchical algorithm lengths of found paths are compared
+    with the shortest ones after timing (see checkPath()). Statistics is written as JSON object if output format is
+    ResultWriter::JsonFormat and as text line otherwise.
+*/
+void AppController::setStatsEnabled(bool enabled)
+{
+    m_statsEnabled = enabled;
+}
+
+/*!
+    Enables persistent query mode if \a enabled is true: commands of line protocol (see
+    Session) are read from standard input and one response line per command is written to
+    standard output, until "quit" command or end of input. Game map and search scratch are
+    kept between commands.
+*/
+void AppController::setServeMode(bool enabled)
+{
+    m_serveMode = enabled;
+}
+
+/*!
+    Enables socket server mode if \a socketPath is not empty: clients connected to local
+    (UNIX-domain) socket \a socketPath share named game maps, and their queries are solved by
+    threadCount() worker threads. See SocketServer for protocol description.
+*/
+void AppController::setSocketPath(const std::string &socketPath)
 {
+    m_socketPath = socketPath;
 }
 
 /*!
     Executes the application.
-    \param filePath Path to input file.
+    \param filePath Path to input file (optional in serve mode).
 */
 bool AppController::exec(const std::string &filePath)
 {
+    if (!m_socketPath.empty())
+        return execSocketServer(filePath);
+    if (m_serveMode)
+        return execServe(filePath);
+
     // Reading input data
+    Clock::time_point t0 = Clock::now();
     InputReader reader;
-    if (!reader.read(filePath)) {
+    reader.setComponentsEnabled(m_componentsEnabled);
+    reader.setClusterSize(effectiveClusterSize(), m_entranceMode);
+    reader.setLandmarkCount(effectiveLandmarkCount(), m_selectionMode);
+    if (!reader.read(filePath, m_batchMode)) {
         std::cerr << reader.errorString() << std::endl;
         return false;
     }
 
-    // Validating input
-    if (!reader.gameMap()->at(reader.startPoint())->isWall) {
-        std::cerr << "Start point must be a ball" << std::endl;
+    Clock::duration loadTime = Clock::now() - t0;
+
+    if (m_batchMode)
+        return execBatch(reader, loadTime);
+    return execSingle(reader, loadTime);
+}
+
+/* private */
+
+/*!
+    Returns size of cluster side of abstract graph to build at load time or 0 if selected
+    algorithm doesn't need it.
+*/
+int AppController::effectiveClusterSize() const
+{
+    return m_algorithm == PathFinder::Hierarchical ? m_clusterSize : 0;
+}
+
+/*!
+    Returns count of landmarks to build tables for at load time or 0 if selected algorithm
+    doesn't use them.
+*/
+int AppController::effectiveLandmarkCount() const
+{
+    return m_algorithm == PathFinder::AStar || m_algorithm == PathFinder::Auto
+            ? m_landmarkCount : 0;
+}
+
+/*!
+    Loads game map from \a filePath (if it's not empty) and executes protocol commands from
+    standard input until "quit" command or end of input.
+*/
+bool AppController::execServe(const std::string &filePath)
+{
+    Session session;
+    session.setAlgorithm(m_algorithm);
+    session.setComponentsEnabled(m_componentsEnabled);
+    session.setClusterSize(effectiveClusterSize(), m_entranceMode);
+    session.setLandmarkCount(effectiveLandmarkCount(), m_selectionMode);
+    session.setOutputFormat(m_outputFormat);
+
+    std::string error;
+    if (!filePath.empty() && !session.load(filePath, error)) {
+        std::cerr << error << std::endl;
         return false;
     }
-    if (reader.gameMap()->at(reader.finishPoint())->isWall) {
-        std::cerr << "Finish point must be empty (not a ball)" << std::endl;
+
+    std::string command;
+    std::string response;
+    while (std::getline(std::cin, command)) {
+        if (!session.execute(command, response))
+            break;
+        if (response.empty())
+            continue;
+        std::cout.write(response.data(), response.size());
+        std::cout.flush();
+        if (!std::cout.good()) {
+            std::cerr << "Error occurred when writing result" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+    Loads game map from \a filePath (if it's not empty) as map named "default" and serves
+    clients of socket until "shutdown" command.
+*/
+bool AppController::execSocketServer(const std::string &filePath)
+{
+    SocketServer server;
+    server.setThreadCount(m_threadCount);
+    server.setAlgorithm(m_algorithm);
+    server.setComponentsEnabled(m_componentsEnabled);
+    server.setClusterSize(effectiveClusterSize(), m_entranceMode);
+    server.setLandmarkCount(effectiveLandmarkCount(), m_selectionMode);
+    server.setOutputFormat(m_outputFormat);
+
+    std::string error;
+    if ((!filePath.empty() && !server.load("default", filePath, error))
+            || !server.exec(m_socketPath, error)) {
+        std::cerr << error << std::endl;
         return false;
     }
+    return true;
+}
 
-    // Finding the path
-    PathFinder finder(reader.gameMap(), reader.startPoint(), reader.finishPoint());
-    if (!finder.findPath()) {
-        std::cout << "There is no path" << std::endl;
-        return true;
+/*!
+    Finds path for the only (first) query of \a reader and writes result in default format.
+*/
+bool AppController::execSingle(const InputReader &reader, Clock::duration loadTime)
+{
+    // Validating input
+    std::string error;
+    if (!validateQuery(*reader.gameMap(), reader.queries().front(), error)) {
+        std::cerr << error << std::endl;
+        return false;
     }
 
+    // Finding the path
+    PathFinder finder(reader.gameMap());
+    finder.setAlgorithm(m_algorithm);
+    Clock::time_point t0 = Clock::now();
+    finder.findPath(reader.startPoint(), reader.finishPoint());
+    Clock::duration searchTime = Clock::now() - t0;
+
     // Writing result
-    if (!ResultWriter::write(*reader.gameMap(), finder.path())) {
+    t0 = Clock::now();
+    ResultWriter writer;
+    writer.setFormat(m_outputFormat);
+    writer.write(*reader.gameMap(), reader.queries().front(), finder.path(),
+                 finder.expandedCount());
+    if (!writer.flush()) {
         std::cerr << "Error occurred when writing result" << std::endl;
         return false;
     }
+    Clock::duration renderTime = Clock::now() - t0;
 
+    if (m_statsEnabled) {
+        PathQuality quality;
+        if (m_algorithm == PathFinder::Hierarchical) {
+            PathFinder reference(reader.gameMap());
+            reference.setAlgorithm(PathFinder::AStar);
+            checkPath(reference, reader.queries().front(), finder.path(), quality);
+        }
+        writeStats(reader, loadTime, searchTime, renderTime, finder.expandedCount(),
+                   finder.stats(), quality);
+    }
     return true;
 }
+
+/*!
+    Finds paths for all the queries of \a reader and writes one result line per query.
+    Queries are spread across threadCount() threads, but results are written in input order.
+    Aggregate timing (including \a loadTime spent for reading input) is written to error
+    stream, so output contains only results.
+*/
+bool AppController::execBatch(const InputReader &reader, Clock::duration loadTime)
+{
+    const GameMap &gameMap = *reader.gameMap();
+    const std::vector<Query> &queries = reader.queries();
+    std::vector<QueryResult> results(queries.size());
+
+    Clock::time_point t0 = Clock::now();
+    solveQueries(gameMap, queries, results);
+    Clock::duration searchTime = Clock::now() - t0;
+
+    int found = 0;
+    long long expanded = 0;
+    long long backwardExpanded = 0;
+    SearchStats stats;
+    t0 = Clock::now();
+    std::size_t outputSize = 0;
+    for (const QueryResult &result : results)
+        outputSize += 64 + result.error.size() + 3 * result.path.size();
+
+    ResultWriter writer;
+    writer.setFormat(m_outputFormat);
+    writer.reserve(outputSize);
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        expanded += results[i].expandedCount;
+        backwardExpanded += results[i].backwardExpandedCount;
+        stats.add(results[i].stats);
+        if (!results[i].error.empty()) {
+            writer.writeQueryError(gameMap, queries[i], results[i].error);
+        } else {
+            if (results[i].path.size() >= 2)
+                ++found;
+            writer.writeQueryResult(gameMap, queries[i], results[i].path,
+                                    results[i].expandedCount);
+        }
+    }
+    if (!writer.flush()) {
+        std::cerr << "Error occurred when writing result" << std::endl;
+        return false;
+    }
+    Clock::duration renderTime = Clock::now() - t0;
+
+    const int count = static_cast<int>(queries.size());
+    std::cerr << "Map load time: " << toMsecs(loadTime) << " ms";
+    if (gameMap.components())
+        std::cerr << ", components: " << gameMap.components()->componentCount();
+    if (gameMap.clusters())
+        std::cerr << ", abstract nodes: " << gameMap.clusters()->nodeCount();
+    if (gameMap.landmarks())
+        std::cerr << ", landmarks: " << gameMap.landmarks()->landmarkCount();
+    std::cerr << ", queries: " << count << ", paths found: " << found
+              << ", expanded: " << expanded;
+    if (m_algorithm == PathFinder::BidirectionalAStar)
+        std::cerr << " (forward: " << expanded - backwardExpanded
+                  << ", backward: " << backwardExpanded << ")";
+    std::cerr << ", threads: " << m_threadCount
+              << ", search time: " << toMsecs(searchTime) << " ms"
+              << " (" << count / (toMsecs(searchTime) / 1000.0) << " queries/s)" << std::endl;
+    if (m_statsEnabled) {
+        PathQuality quality;
+        if (m_algorithm == PathFinder::Hierarchical) {
+            PathFinder reference(&gameMap);
+            reference.setAlgorithm(PathFinder::AStar);
+            for (std::size_t i = 0; i < queries.size(); ++i)
+                checkPath(reference, queries[i], results[i].path, quality);
+        }
+        writeStats(reader, loadTime, searchTime, renderTime, expanded, stats, quality);
+    }
+    return true;
+}
+
+/*!
+    Finds paths for all the \a queries at \a gameMap and stores them into \a results (which must
+    have the same size as \a queries).
+
+    Game map is shared by all the threads (it's never modified by search), but every thread has
+    its own PathFinder with its own search scratch. Queries are distributed between threads in
+    contiguous chunks; long-running queries (e.g. ones without path) are balanced by work
+    stealing (see ThreadPool).
+*/
+void AppController::solveQueries(const GameMap &gameMap, const std::vector<Query> &queries,
+                                 std::vector<QueryResult> &results) const
+{
+    const int count = static_cast<int>(queries.size());
+    const int threadCount = Math::min(m_threadCount, count);
+
+    if (threadCount <= 1) {
+        PathFinder finder(&gameMap);
+        finder.setAlgorithm(m_algorithm);
+        for (int i = 0; i < count; ++i)
+            solveQuery(finder, gameMap, queries[i], results[i]);
+        return;
+    }
+
+    std::vector<PathFinder *> finders;
+    for (int i = 0; i < threadCount; ++i) {
+        finders.push_back(new PathFinder(&gameMap));
+        finders.back()->setAlgorithm(m_algorithm);
+    }
+
+    {
+        ThreadPool pool(threadCount);
+        for (int i = 0; i < count; ++i) {
+            int chunk = static_cast<int>(static_cast<long long>(i) * threadCount / count);
+            pool.submit(chunk, [&, i](int worker) {
+                solveQuery(*finders[worker], gameMap, queries[i], results[i]);
+            });
+        }
+        pool.wait();
+    }
+
+    for (auto finder : finders)
+        delete finder;
+}
+
+/*!
+    Finds path for \a query using \a finder and stores it into \a result.
+*/
+void AppController::solveQuery(PathFinder &finder, const GameMap &gameMap, const Query &query,
+                               QueryResult &result)
+{
+    if (!validateQuery(gameMap, query, result.error))
+        return;
+    finder.findPath(query.start, query.finish);
+    finder.takePath(result.path);
+    result.expandedCount = finder.expandedCount();
+    result.backwardExpandedCount = finder.backwardExpandedCount();
+    result.stats = finder.stats();
+}
+
+/*!
+    Checks that \a query is valid for \a gameMap: start point must be a ball and finish point
+    must be empty. Otherwise returns false and sets \a error.
+*/
+bool AppController::validateQuery(const GameMap &gameMap, const Query &query, std::string &error)
+{
+    if (!gameMap.isWall(query.start)) {
+        error = "Start point must be a ball";
+        return false;
+    }
+    if (gameMap.isWall(query.finish)) {
+        error = "Finish point must be empty (not a ball)";
+        return false;
+    }
+    return true;
+}
+
+/*!
+    Compares length of \a path found for \a query with the shortest one found by \a reference
+    finder (which must use an exact algorithm) and counts it in \a quality. Empty path isn't
+    counted.
+*/
+void AppController::checkPath(PathFinder &reference, const Query &query, const Path &path,
+                              PathQuality &quality)
+{
+    if (path.empty() || !reference.findPath(query.start, query.finish))
+        return;
+    ++quality.checkedCount;
+    if (path.length() > reference.path().length()) {
+        const double ratio = double(path.length()) / reference.path().length();
+        ++quality.longerCount;
+        quality.ratioSum += ratio;
+        quality.maxRatio = Math::max(quality.maxRatio, ratio);
+    }
+}
+
+/*!
+    Writes statistics of run to error stream (see setStatsEnabled()): \a loadTime of reading
+    \a reader (which is split to parsing and building), \a searchTime, \a renderTime of writing
+    results, count of expanded nodes \a expandedCount, search counters \a stats (sum for all
+    the queries in batch mode) and \a quality of paths (if any were checked). Search counters
+    are written only if they are collected by this build (see SearchStats::isEnabled()).
+*/
+void AppController::writeStats(const InputReader &reader, Clock::duration loadTime,
+                               Clock::duration searchTime, Clock::duration renderTime,
+                               long long expandedCount, const SearchStats &stats,
+                               const PathQuality &quality) const
+{
+    const double meanRatio = quality.longerCount ? quality.ratioSum / quality.longerCount : 1;
+    const double buildTime = reader.buildTime();
+    const double clusterBuildTime = reader.clusterBuildTime();
+    const double landmarkBuildTime = reader.landmarkBuildTime();
+    const double parseTime = toMsecs(loadTime) - buildTime - clusterBuildTime - landmarkBuildTime;
+    const ComponentIndex *components = reader.gameMap()->components();
+    const ClusterGraph *clusters = reader.gameMap()->clusters();
+    const LandmarkIndex *landmarks = reader.gameMap()->landmarks();
+    const bool isJson = m_outputFormat == ResultWriter::JsonFormat;
+
+    if (isJson) {
+        std::cerr << "{\"parse_ms\":" << parseTime << ",\"build_ms\":" << buildTime;
+        if (components) {
+            std::cerr << ",\"components\":" << components->componentCount()
+                      << ",\"components_memory\":" << components->memoryUsage();
+        }
+        if (clusters) {
+            std::cerr << ",\"clusters_build_ms\":" << clusterBuildTime
+                      << ",\"clusters_memory\":" << clusters->memoryUsage()
+                      << ",\"abstract_nodes\":" << clusters->nodeCount()
+                      << ",\"abstract_edges\":" << clusters->edgeCount();
+        }
+        if (landmarks) {
+            std::cerr << ",\"landmarks_build_ms\":" << landmarkBuildTime
+                      << ",\"landmarks_memory\":" << landmarks->memoryUsage()
+                      << ",\"landmarks\":" << landmarks->landmarkCount();
+        }
+        std::cerr << ",\"search_ms\":" << toMsecs(searchTime);
+        if (SearchStats::isEnabled())
+            std::cerr << ",\"reconstruct_ms\":" << stats.reconstructTime;
+        std::cerr << ",\"render_ms\":" << toMsecs(renderTime)
+                  << ",\"expanded\":" << expandedCount;
+        if (SearchStats::isEnabled()) {
+            std::cerr << ",\"pushed\":" << stats.pushedCount
+                      << ",\"decrease_key\":" << stats.decreaseKeyCount
+                      << ",\"max_open\":" << stats.maxOpenSize
+                      << ",\"closed\":" << stats.closedCount;
+        }
+        if (quality.checkedCount) {
+            std::cerr << ",\"checked_paths\":" << quality.checkedCount
+                      << ",\"longer_paths\":" << quality.longerCount
+                      << ",\"longer_mean_ratio\":" << meanRatio
+                      << ",\"longer_max_ratio\":" << quality.maxRatio;
+        }
+        std::cerr << '}' << std::endl;
+        return;
+    }
+
+    std::cerr << "Stats: parse " << parseTime << " ms, build " << buildTime << " ms";
+    if (components) {
+        std::cerr << ", memory " << components->memoryUsage() << " bytes ("
+                  << components->componentCount() << " components)";
+    }
+    if (clusters) {
+        std::cerr << ", clusters build " << clusterBuildTime << " ms, memory "
+                  << clusters->memoryUsage() << " bytes (" << clusters->nodeCount()
+                  << " nodes, " << clusters->edgeCount() << " edges)";
+    }
+    if (landmarks) {
+        std::cerr << ", landmarks build " << landmarkBuildTime << " ms, memory "
+                  << landmarks->memoryUsage() << " bytes (" << landmarks->landmarkCount()
+                  << " landmarks)";
+    }
+    std::cerr << ", search " << toMsecs(searchTime) << " ms";
+    if (SearchStats::isEnabled())
+        std::cerr << " (reconstruct " << stats.reconstructTime << " ms)";
+    std::cerr << ", render " << toMsecs(renderTime) << " ms, expanded " << expandedCount;
+    if (SearchStats::isEnabled()) {
+        std::cerr << ", pushed " << stats.pushedCount
+                  << ", decrease-key " << stats.decreaseKeyCount
+                  << ", max open " << stats.maxOpenSize
+                  << ", closed " << stats.closedCount;
+    } else {
+        std::cerr << " (search counters are disabled in this build)";
+    }
+    if (quality.checkedCount) {
+        std::cerr << ", longer than shortest " << quality.longerCount << " of "
+                  << quality.checkedCount << " paths (mean ratio " << meanRatio << ", max "
+                  << quality.maxRatio << ")";
+    }
+    std::cerr << std::endl;
+}
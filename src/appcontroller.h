@@ -1,7 +1,17 @@
 #ifndef APPCONTROLLER_H
 #define APPCONTROLLER_H
 
+#include <chrono>
 #include <string>
+#include <vector>
+#include "core/gamemap.h"
+#include "core/path.h"
+#include "core/pathfinder.h"
+#include "core/query.h"
+#include "core/searchstats.h"
+#include "resultwriter.h"
+
+class InputReader;
 
 class AppController
 {
@@ -9,7 +19,75 @@ class AppController
 public:
     AppController();
 
+    void setBatchMode(bool enabled);
+    void setThreadCount(int count);
+    void setAlgorithm(PathFinder::Algorithm algorithm);
+    void setComponentsEnabled(bool enabled);
+    void setClusterSize(int clusterSize, ClusterGraph::EntranceMode mode);
+    void setLandmarkCount(int count, LandmarkIndex::SelectionMode mode);
+    void setOutputFormat(ResultWriter::Format format);
+    void setStatsEnabled(bool enabled);
+    void setServeMode(bool enabled);
+    void setSocketPath(const std::string &socketPath);
     bool exec(const std::string &filePath);
+
+    static bool validateQuery(const GameMap &gameMap, const Query &query, std::string &error);
+
+private:
+    struct QueryResult
+    {
+        std::string error; //!< Empty if query is valid.
+        Path path;
+        int expandedCount;
+        int backwardExpandedCount;
+        SearchStats stats;
+
+        QueryResult() : expandedCount(0), backwardExpandedCount(0) {}
+    };
+
+    /*!
+        \struct AppController::PathQuality
+        \brief Lengths of found paths compared with the shortest ones (see checkPath()).
+    */
+    struct PathQuality
+    {
+        int checkedCount; //!< Found paths compared with the shortest ones.
+        int longerCount;  //!< Paths longer than the shortest ones.
+        double ratioSum;  //!< Sum of length ratios of longer paths.
+        double maxRatio;  //!< Maximal length ratio.
+
+        PathQuality() : checkedCount(0), longerCount(0), ratioSum(0), maxRatio(1) {}
+    };
+
+    bool m_batchMode;
+    int m_threadCount;
+    PathFinder::Algorithm m_algorithm;
+    bool m_componentsEnabled;
+    int m_clusterSize;
+    ClusterGraph::EntranceMode m_entranceMode;
+    int m_landmarkCount;
+    LandmarkIndex::SelectionMode m_selectionMode;
+    ResultWriter::Format m_outputFormat;
+    bool m_statsEnabled;
+    bool m_serveMode;
+    std::string m_socketPath;
+
+    int effectiveClusterSize() const;
+    int effectiveLandmarkCount() const;
+    bool execSingle(const InputReader &reader, std::chrono::steady_clock::duration loadTime);
+    bool execServe(const std::string &filePath);
+    bool execSocketServer(const std::string &filePath);
+    bool execBatch(const InputReader &reader, std::chrono::steady_clock::duration loadTime);
+    void solveQueries(const GameMap &gameMap, const std::vector<Query> &queries,
+                      std::vector<QueryResult> &results) const;
+    static void solveQuery(PathFinder &finder, const GameMap &gameMap, const Query &query,
+                           QueryResult &result);
+    static void checkPath(PathFinder &reference, const Query &query, const Path &path,
+                          PathQuality &quality);
+    void writeStats(const InputReader &reader, std::chrono::steady_clock::duration loadTime,
+                    std::chrono::steady_clock::duration searchTime,
+                    std::chrono::steady_clock::duration renderTime, long long expandedCount,
+                    const SearchStats &stats, const PathQuality &quality) const;
 };
 
 #endif // APPCONTROLLER_H
@@ -0,0 +1,122 @@
+#ifndef BINARYMAP_H
+#define BINARYMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "util/endian.h"
+
+/*!
+    \namespace BinaryMap
+    \brief Layout of binary game map file (see InputReader for format description).
+
+    All the fields and arrays of sections are little-endian regardless of host byte order:
+    structures are converted by convertByteOrder() and array items by Endian functions.
+    Sections start at offsets aligned to 8 bytes, so on little-endian hosts arrays can be used
+    right from memory-mapped file.
+*/
+
+namespace BinaryMap {
+
+const char Magic[8] = { 'B', 'A', 'L', 'L', 'M', 'A', 'P', '\0' };
+const std::uint32_t Version = 1;
+const std::size_t Alignment = 8;
+
+enum SectionType {
+    WallsSection = 1,       //!< Free bits of every row, packed as GameMap::freeRow().
+    QueriesSection = 2,     //!< Additional queries: start x, y and finish x, y (int32 each).
+    ComponentsSection = 3,  //!< Component of every cell row by row (int32, -1 for walls).
+    LandmarksSection = 4    //!< Landmark tables, see LandmarksHeader.
+};
+
+/*!
+    \struct BinaryMap::Header
+    \brief File header; points are in coordinates of input file (Y-axis is inverted).
+*/
+struct Header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::int32_t width;
+    std::int32_t height;
+    std::int32_t startX;
+    std::int32_t startY;
+    std::int32_t finishX;
+    std::int32_t finishY;
+    std::uint32_t sectionCount; //!< Count of Section entries right after the header.
+    std::uint32_t reserved;
+};
+
+/*!
+    \struct BinaryMap::Section
+    \brief Entry of section table; unknown section types are ignored by reader.
+*/
+struct Section
+{
+    std::uint32_t type;
+    std::uint32_t reserved;
+    std::uint64_t offset; //!< From the beginning of file.
+    std::uint64_t size;   //!< In bytes.
+};
+
+/*!
+    \struct BinaryMap::LandmarksHeader
+    \brief Beginning of landmarks section; it's followed by cell number (y * width + x, int32)
+    of every landmark and then by distances from all the landmarks (uint16 each, see
+    LandmarkIndex) for every cell row by row.
+*/
+struct LandmarksHeader
+{
+    std::uint32_t landmarkCount;
+    std::uint32_t reserved;
+};
+
+/*!
+    Converts fields of \a header from host to little-endian byte order or back.
+*/
+inline void convertByteOrder(Header &header)
+{
+    header.version = Endian::toLittle(header.version);
+    header.headerSize = Endian::toLittle(header.headerSize);
+    header.width = Endian::toLittle(header.width);
+    header.height = Endian::toLittle(header.height);
+    header.startX = Endian::toLittle(header.startX);
+    header.startY = Endian::toLittle(header.startY);
+    header.finishX = Endian::toLittle(header.finishX);
+    header.finishY = Endian::toLittle(header.finishY);
+    header.sectionCount = Endian::toLittle(header.sectionCount);
+    header.reserved = Endian::toLittle(header.reserved);
+}
+
+/*!
+    Converts fields of \a section from host to little-endian byte order or back.
+*/
+inline void convertByteOrder(Section &section)
+{
+    section.type = Endian::toLittle(section.type);
+    section.reserved = Endian::toLittle(section.reserved);
+    section.offset = Endian::toLittle(section.offset);
+    section.size = Endian::toLittle(section.size);
+}
+
+/*!
+    Converts fields of \a header from host to little-endian byte order or back.
+*/
+inline void convertByteOrder(LandmarksHeader &header)
+{
+    header.landmarkCount = Endian::toLittle(header.landmarkCount);
+    header.reserved = Endian::toLittle(header.reserved);
+}
+
+/*!
+    Returns true if \a size bytes of \a data start with binary map signature.
+*/
+inline bool isBinary(const char *data, std::size_t size)
+{
+    return size >= sizeof(Magic) && !std::memcmp(data, Magic, sizeof(Magic));
+}
+
+} // namespace BinaryMap
+
+#endif // BINARYMAP_H
@@ -0,0 +1,93 @@
+#ifndef BINARYRESULT_H
+#define BINARYRESULT_H
+
+#include <cstddef>
+#include <cstdint>
+#include "util/endian.h"
+
+/*!
+    \namespace BinaryResult
+    \brief Layout of binary output of ResultWriter (see ResultWriter::BinaryFormat).
+
+    Output starts with Header, followed by one Record per query. Every record is followed by
+    its moves packed by 4 per byte (2 bits per move, lowest bits first, see Move), padded with
+    zero bytes to Alignment. All the fields are little-endian regardless of host byte order
+    (see convertByteOrder()).
+*/
+
+namespace BinaryResult {
+
+const char Magic[8] = { 'B', 'A', 'L', 'L', 'R', 'E', 'S', '\0' };
+const std::uint32_t Version = 1;
+const std::size_t Alignment = 4;
+
+enum Status {
+    Found = 0,      //!< Path found; Record::length moves follow the record.
+    NotFound = 1,   //!< There is no path.
+    Invalid = 2     //!< Query is invalid (e.g. start point isn't a ball).
+};
+
+enum Move { Left = 0, Right = 1, Up = 2, Down = 3 };
+
+/*!
+    \struct BinaryResult::Header
+    \brief Output header.
+*/
+struct Header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+};
+
+/*!
+    \struct BinaryResult::Record
+    \brief Result of one query; points are in coordinates of input file (Y-axis is inverted).
+*/
+struct Record
+{
+    std::int32_t startX;
+    std::int32_t startY;
+    std::int32_t finishX;
+    std::int32_t finishY;
+    std::uint32_t status;       //!< One of Status values.
+    std::uint32_t length;       //!< Count of moves (0 if path isn't found).
+    std::uint32_t expanded;     //!< Count of nodes expanded by search.
+    std::uint32_t reserved;
+};
+
+/*!
+    Converts fields of \a header from host to little-endian byte order or back.
+*/
+inline void convertByteOrder(Header &header)
+{
+    header.version = Endian::toLittle(header.version);
+    header.headerSize = Endian::toLittle(header.headerSize);
+}
+
+/*!
+    Converts fields of \a record from host to little-endian byte order or back.
+*/
+inline void convertByteOrder(Record &record)
+{
+    record.startX = Endian::toLittle(record.startX);
+    record.startY = Endian::toLittle(record.startY);
+    record.finishX = Endian::toLittle(record.finishX);
+    record.finishY = Endian::toLittle(record.finishY);
+    record.status = Endian::toLittle(record.status);
+    record.length = Endian::toLittle(record.length);
+    record.expanded = Endian::toLittle(record.expanded);
+    record.reserved = Endian::toLittle(record.reserved);
+}
+
+/*!
+    Returns count of bytes used by \a length packed moves (including padding).
+*/
+inline std::size_t movesSize(std::size_t length)
+{
+    return ((length + 3) / 4 + Alignment - 1) / Alignment * Alignment;
+}
+
+} // namespace BinaryResult
+
+#endif // BINARYRESULT_H
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <limits>
+#include "core/astarengine.h"
+
+namespace {
+    const int StepCost = 1;
+    const int NoParent = -1;
+} // anonymous namespace
+
+/*!
+    \class AStarEngine
+    \brief Implements A* (A-Star) algorithm for finding shortest path at game map.
+
+    In a nutshell, A* is most effective algorithm for finding of optimal path.
+
+    Search fields (parent, g and closed flag) are kept in SearchContext arrays parallel to
+    game map cells and indexed by cell index, so expanding of a node touches only a few
+    contiguous arrays and game map itself is never modified.
+
+    In bidirectional mode (see setBidirectional()) two searches run towards each other:
+    forward one from start point and backward one from finish point; side with smaller open
+    list is expanded on every step. Both sides use balanced heuristic: half of difference of
+    Manhattan distances to own target and to the other side's target. Such heuristics are
+    consistent and sum to zero, so both searches work as bidirectional Dijkstra on the same
+    reweighted graph: every cell reached by both sides gives a path, the best one (with cost
+    mu) is kept, and search stops when sum of minimal keys of both open lists reaches mu, which
+    guarantees that the path is the shortest one. Then it's stitched of forward parents chain
+    from meeting cell back to start and backward parents chain from meeting cell to finish.
+    When the finish is enclosed in small region, backward search exhausts it almost at once.
+
+    If game map has distance tables of landmarks (see GameMap::buildLandmarks()), heuristic of
+    unidirectional search is the larger of Manhattan distance and landmark bound (ALT, see
+    LandmarkIndex::lowerBound()); both are consistent, so is their maximum, and paths stay the
+    shortest. On maps with walls and corridors it cuts count of expanded nodes many times.
+    Bidirectional search keeps Manhattan distance, as landmark bound to the start point (which
+    is a ball, so it isn't in tables) isn't defined.
+
+    You can read about this algorithm at:\n
+    \htmlonly
+    <a href="http://www.policyalmanac.org/games/aStarTutorial.htm">A* Tutorial</a><br>
+    <a href="http://en.wikipedia.org/wiki/A*_search_algorithm">A* at Wikipedia</a>
+    \endhtmlonly
+*/
+
+/*!
+    Constructs A* engine.
+    \param gm Game map to search paths at.
+    \param context Scratch state for searches.
+    \param openListType Priority queue implementation used for open list: binary heap
+    (IndexedHeap) or bucket queue (BucketQueue); both support O(log n) or O(1) "decrease key".
+*/
+AStarEngine::AStarEngine(const GameMap *gm, SearchContext *context, OpenListType openListType)
+    : SearchEngine(gm, context), m_openListType(openListType), m_bidirectional(false),
+      m_backwardExpandedCount(0), m_meeting(NoParent), m_landmarks(0)
+{
+}
+
+/*!
+    Enables bidirectional search if \a enabled is true (it's disabled by default).
+*/
+void AStarEngine::setBidirectional(bool enabled)
+{
+    m_bidirectional = enabled;
+}
+
+/*!
+    Returns true if bidirectional search is enabled.
+*/
+bool AStarEngine::isBidirectional() const
+{
+    return m_bidirectional;
+}
+
+bool AStarEngine::findPath(const Point &start, const Point &finish, std::vector<int> &cells)
+{
+    m_expandedCount = 0;
+    m_backwardExpandedCount = 0;
+    m_stats.clear();
+    m_context->reset(m_gameMap->indexCount());
+
+    if (m_bidirectional) {
+        m_backward.reset(m_gameMap->indexCount());
+        if (!(m_openListType == HeapOpenList
+              ? searchBidirectional(m_context->heap(), m_backward.heap(), start, finish)
+              : searchBidirectional(m_context->buckets(), m_backward.buckets(), start, finish)))
+            return false;
+        reconstructBidirectionalPath(cells);
+        return true;
+    }
+
+    m_landmarks = m_gameMap->landmarks();
+    if (!(m_openListType == HeapOpenList ? search(m_context->heap(), start, finish)
+                                         : search(m_context->buckets(), start, finish)))
+        return false;
+
+    reconstructPath(m_gameMap->index(finish), cells);
+    return true;
+}
+
+/*!
+    Returns count of nodes expanded by backward search during last findPath() call; they're
+    included into expandedCount() as well.
+*/
+int AStarEngine::backwardExpandedCount() const
+{
+    return m_backwardExpandedCount;
+}
+
+/*!
+    Returns count of bytes allocated for backward search scratch.
+*/
+std::size_t AStarEngine::memoryUsage() const
+{
+    return m_backward.memoryUsage();
+}
+
+/* private */
+
+/*!
+    Runs A* algorithm from \a start to \a finish using \a openList as open list.
+    \return true if path found.
+*/
+template <typename OpenList>
+bool AStarEngine::search(OpenList &openList, const Point &start, const Point &finish)
+{
+    const int offsets[] = { -1, 1, -m_gameMap->rowStride(), m_gameMap->rowStride() };
+    const int startIndex = m_gameMap->index(start);
+    const int finishIndex = m_gameMap->index(finish);
+    SearchContext &ctx = *m_context;
+
+    openList.reserve(m_gameMap->indexCount());
+    ctx.reach(startIndex, 0, NoParent);
+    openList.push(startIndex, heuristicCostEstimate(start, finish));
+    SEARCH_STAT(++m_stats.pushedCount);
+
+    while (!openList.isEmpty()) {
+        int x = openList.pop();
+        if (x == finishIndex) {
+            openList.clear();
+            return true;
+        }
+
+        ctx.close(x);
+        ++m_expandedCount;
+        SEARCH_STAT(++m_stats.closedCount);
+
+        // Testing for each neighbour of x
+        for (int k = 0; k < 4; ++k) {
+            int y = x + offsets[k];
+            if (m_gameMap->isWall(y) || ctx.isClosed(y))
+                continue; // skip walls (including frame and start point) and closed-list neighbours
+
+            // Calculating g(x) for processing neighbour
+            int tentativeG = ctx.g(x) + StepCost;
+
+            if (!ctx.isReached(y)) {
+                ctx.reach(y, tentativeG, x);
+                openList.push(y, tentativeG + heuristicCostEstimate(y, finish, finishIndex));
+                SEARCH_STAT(++m_stats.pushedCount);
+            } else if (tentativeG < ctx.g(y)) {
+                ctx.reach(y, tentativeG, x);
+                openList.decreaseKey(y, tentativeG + heuristicCostEstimate(y, finish,
+                                                                           finishIndex));
+                SEARCH_STAT(++m_stats.decreaseKeyCount);
+            }
+        }
+        SEARCH_STAT(m_stats.maxOpenSize = Math::max(m_stats.maxOpenSize, openList.size()));
+    }
+
+    // Path not found
+    return false;
+}
+
+/*!
+    Runs bidirectional A* algorithm: \a forward open list from \a start and \a backward one
+    from \a finish (see class description).
+    \return true if path found; meeting cell is stored into m_meeting.
+*/
+template <typename OpenList>
+bool AStarEngine::searchBidirectional(OpenList &forward, OpenList &backward, const Point &start,
+                                      const Point &finish)
+{
+    const int offsets[] = { -1, 1, -m_gameMap->rowStride(), m_gameMap->rowStride() };
+    const int startIndex = m_gameMap->index(start);
+    const int finishIndex = m_gameMap->index(finish);
+    const int distance = heuristicCostEstimate(start, finish);
+    int best = std::numeric_limits<int>::max();
+    m_meeting = NoParent;
+
+    forward.reserve(m_gameMap->indexCount());
+    backward.reserve(m_gameMap->indexCount());
+    m_context->reach(startIndex, 0, NoParent);
+    forward.push(startIndex, 0);
+    m_backward.reach(finishIndex, 0, NoParent);
+    backward.push(finishIndex, 0);
+    SEARCH_STAT(m_stats.pushedCount += 2);
+
+    while (!forward.isEmpty() && !backward.isEmpty()) {
+        if (best != std::numeric_limits<int>::max()
+                && forward.minKey() + backward.minKey() >= 2 * (best + distance))
+            break; // no path shorter than the best one remains
+
+        const bool isForward = forward.size() <= backward.size();
+        OpenList &openList = isForward ? forward : backward;
+        SearchContext &ctx = isForward ? *m_context : m_backward;
+        const SearchContext &other = isForward ? m_backward : *m_context;
+
+        const int x = openList.pop();
+        ctx.close(x);
+        ++m_expandedCount;
+        if (!isForward)
+            ++m_backwardExpandedCount;
+        SEARCH_STAT(++m_stats.closedCount);
+
+        for (int k = 0; k < 4; ++k) {
+            const int y = x + offsets[k];
+            const int tentativeG = ctx.g(x) + StepCost;
+
+            if (y == startIndex && !isForward) {
+                // Start point is a ball: backward search only touches it and never goes on
+                if (!ctx.isReached(y) || tentativeG < ctx.g(y))
+                    ctx.reach(y, tentativeG, x);
+            } else if (m_gameMap->isWall(y) || ctx.isClosed(y)) {
+                continue;
+            } else if (!ctx.isReached(y) || tentativeG < ctx.g(y)) {
+                // Doubled key: 2g + (h to own target - h to other target) + 2 * distance
+                const Point p = m_gameMap->point(y);
+                const int balance = heuristicCostEstimate(p, finish)
+                        - heuristicCostEstimate(p, start);
+                const int key = 2 * tentativeG + (isForward ? balance : -balance) + distance;
+                if (!ctx.isReached(y)) {
+                    openList.push(y, key);
+                    SEARCH_STAT(++m_stats.pushedCount);
+                } else {
+                    openList.decreaseKey(y, key);
+                    SEARCH_STAT(++m_stats.decreaseKeyCount);
+                }
+                ctx.reach(y, tentativeG, x);
+            }
+
+            if (other.isReached(y) && ctx.g(y) + other.g(y) < best) {
+                best = ctx.g(y) + other.g(y);
+                m_meeting = y;
+            }
+        }
+        SEARCH_STAT(m_stats.maxOpenSize = Math::max(m_stats.maxOpenSize,
+                                                    forward.size() + backward.size()));
+    }
+
+    forward.clear();
+    backward.clear();
+    return m_meeting != NoParent;
+}
+
+/*!
+    Fills \a cells with path cells (by parents, started with cell \a finishIndex).
+*/
+void AStarEngine::reconstructPath(int finishIndex, std::vector<int> &cells) const
+{
+    cells.clear();
+    for (int cur = finishIndex; cur != NoParent; cur = m_context->parent(cur))
+        cells.push_back(cur);
+    std::reverse(cells.begin(), cells.end());
+}
+
+/*!
+    Fills \a cells with path cells of bidirectional search: forward parents chain from meeting
+    cell to start (reversed) followed by backward parents chain from meeting cell to finish.
+*/
+void AStarEngine::reconstructBidirectionalPath(std::vector<int> &cells) const
+{
+    reconstructPath(m_meeting, cells);
+    for (int cur = m_backward.parent(m_meeting); cur != NoParent; cur = m_backward.parent(cur))
+        cells.push_back(cur);
+}
+
+/*!
+    Returns estimated heuristical cost for path from \a p1 to \a p2.
+*/
+int AStarEngine::heuristicCostEstimate(const Point &p1, const Point &p2) const
+{
+    return p2.manhattanLengthTo(p1) * StepCost;
+}
+
+/*!
+    Returns estimated heuristical cost for path from empty cell with index \a index to
+    \a finish (with index \a finishIndex): Manhattan distance or landmark bound, whichever is
+    larger, if game map has landmark tables.
+*/
+int AStarEngine::heuristicCostEstimate(int index, const Point &finish, int finishIndex) const
+{
+    const int estimate = heuristicCostEstimate(m_gameMap->point(index), finish);
+    if (!m_landmarks)
+        return estimate;
+    return Math::max(estimate, m_landmarks->lowerBound(index, finishIndex) * StepCost);
+}
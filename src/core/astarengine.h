@@ -0,0 +1,40 @@
+#ifndef ASTARENGINE_H
+#define ASTARENGINE_H
+
+#include <cstddef>
+#include "core/searchengine.h"
+
+class AStarEngine : public SearchEngine
+{
+public:
+    enum OpenListType { HeapOpenList, BucketOpenList };
+
+    AStarEngine(const GameMap *gm, SearchContext *context, OpenListType openListType);
+
+    void setBidirectional(bool enabled);
+    bool isBidirectional() const;
+
+    bool findPath(const Point &start, const Point &finish, std::vector<int> &cells);
+    int backwardExpandedCount() const;
+    std::size_t memoryUsage() const;
+
+private:
+    OpenListType m_openListType;
+    bool m_bidirectional;
+    SearchContext m_backward; //!< Scratch of backward search (from finish).
+    int m_backwardExpandedCount;
+    int m_meeting;            //!< Cell where forward and backward searches met.
+    const LandmarkIndex *m_landmarks; //!< Of game map during unidirectional search.
+
+    template <typename OpenList>
+    bool search(OpenList &openList, const Point &start, const Point &finish);
+    template <typename OpenList>
+    bool searchBidirectional(OpenList &forward, OpenList &backward, const Point &start,
+                             const Point &finish);
+    void reconstructPath(int finishIndex, std::vector<int> &cells) const;
+    void reconstructBidirectionalPath(std::vector<int> &cells) const;
+    int heuristicCostEstimate(const Point &p1, const Point &p2) const;
+    int heuristicCostEstimate(int index, const Point &finish, int finishIndex) const;
+};
+
+#endif // ASTARENGINE_H
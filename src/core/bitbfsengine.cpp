@@ -0,0 +1,235 @@
+#include <algorithm>
+#include "core/bitbfsengine.h"
+
+namespace {
+    /*!
+        Returns count of set bits in \a word.
+    */
+    inline int popCount(std::uint64_t word)
+    {
+        return __builtin_popcountll(word);
+    }
+} // anonymous namespace
+
+/*!
+    \class BitBfsEngine
+    \brief Implements bit-parallel breadth-first search for finding shortest path at game map.
+
+    As all the steps have the same cost, the shortest path can be found by breadth-first search
+    (BFS). This engine runs BFS over game map packed as bit rows (see GameMap::freeRow()): whole
+    frontier (BFS layer) is stored as bit rows too, and next layer is computed 64 cells at once:
+    frontier shifted left, right, up and down, masked with empty cells and not yet visited ones.
+    There is no per-node priority queue at all, and only bounding rectangle of frontier is
+    processed on every step.
+
+    To reconstruct the path, every visited cell is marked with its BFS distance modulo 3 (two
+    bit planes, written word-wide as well). Distances of adjacent cells differ by at most 1,
+    so the neighbour of a cell at distance d which is marked with (d - 1) % 3 is exactly at
+    distance d - 1; path is walked back from finish by such neighbours.
+
+    Frontier buffers have one-word zero margin around packed rows, so shifting never needs
+    bounds checks.
+
+    \sa AStarEngine
+*/
+
+/*!
+    Constructs BFS engine for searching paths at game map \a gm; \a context isn't used.
+*/
+BitBfsEngine::BitBfsEngine(const GameMap *gm, SearchContext *context)
+    : SearchEngine(gm, context), m_rows(0), m_words(0)
+{
+    m_dirty.rowFirst = m_dirty.wordFirst = 0;
+    m_dirty.rowLast = m_dirty.wordLast = -1;
+}
+
+bool BitBfsEngine::findPath(const Point &start, const Point &finish, std::vector<int> &cells)
+{
+    prepare();
+    m_expandedCount = 0;
+
+    // Layer 0 contains start point only
+    const std::uint64_t startBit = std::uint64_t(1) << (start.x() % 64);
+    const int startWord = start.y() * m_words + start.x() / 64;
+    m_frontier[(start.y() + 1) * (m_words + 2) + start.x() / 64 + 1] = startBit;
+    m_visited[startWord] = startBit;
+
+    Rect cur = { start.y(), start.y(), start.x() / 64, start.x() / 64 };
+    m_dirty = cur;
+
+    const int finishWord = finish.y() * m_words + finish.x() / 64;
+    const std::uint64_t finishBit = std::uint64_t(1) << (finish.x() % 64);
+    int distance = 0;
+
+    while (!(m_visited[finishWord] & finishBit)) {
+        Rect next;
+        int count = expandLayer(cur, ++distance, next);
+        if (count == 0)
+            return false; // frontier is empty, finish is unreachable
+        m_expandedCount += count;
+        m_frontier.swap(m_next);
+        cur = next;
+    }
+
+    // Keep frontier buffer zeroed for the next search
+    for (int y = cur.rowFirst; y <= cur.rowLast; ++y) {
+        std::uint64_t *row = &m_frontier[(y + 1) * (m_words + 2) + 1];
+        std::fill(row + cur.wordFirst, row + cur.wordLast + 1, 0);
+    }
+
+    reconstructPath(start, finish, distance, cells);
+    return true;
+}
+
+/*!
+    Returns count of bytes allocated by engine.
+*/
+std::size_t BitBfsEngine::memoryUsage() const
+{
+    return (m_visited.capacity() + m_phase[0].capacity() + m_phase[1].capacity()
+            + m_frontier.capacity() + m_next.capacity()) * sizeof(std::uint64_t);
+}
+
+/* private */
+
+/*!
+    Clears visited cells of previous search (or reallocates buffers if map size is changed).
+    Frontier buffers are always left zeroed by previous search.
+*/
+void BitBfsEngine::prepare()
+{
+    if (m_rows != m_gameMap->height() || m_words != m_gameMap->rowWords()) {
+        m_rows = m_gameMap->height();
+        m_words = m_gameMap->rowWords();
+        m_visited.assign(m_rows * m_words, 0);
+        m_phase[0].assign(m_rows * m_words, 0);
+        m_phase[1].assign(m_rows * m_words, 0);
+        m_frontier.assign((m_rows + 2) * (m_words + 2), 0);
+        m_next.assign((m_rows + 2) * (m_words + 2), 0);
+        return;
+    }
+
+    for (int y = m_dirty.rowFirst; y <= m_dirty.rowLast; ++y) {
+        const int first = y * m_words + m_dirty.wordFirst;
+        const int last = y * m_words + m_dirty.wordLast + 1;
+        std::fill(m_visited.begin() + first, m_visited.begin() + last, 0);
+        std::fill(m_phase[0].begin() + first, m_phase[0].begin() + last, 0);
+        std::fill(m_phase[1].begin() + first, m_phase[1].begin() + last, 0);
+    }
+}
+
+/*!
+    Computes next BFS layer (cells at \a distance from start) from current frontier, which
+    occupies rectangle \a cur, into m_next and clears current frontier. Rectangle occupied by
+    the next layer is returned in \a next.
+    \return count of cells in the next layer.
+*/
+int BitBfsEngine::expandLayer(const Rect &cur, int distance, Rect &next)
+{
+    const int stride = m_words + 2;
+    const int rowFirst = std::max(cur.rowFirst - 1, 0);
+    const int rowLast = std::min(cur.rowLast + 1, m_rows - 1);
+    const int wordFirst = std::max(cur.wordFirst - 1, 0);
+    const int wordLast = std::min(cur.wordLast + 1, m_words - 1);
+    const int phase = distance % 3;
+    int count = 0;
+
+    next.rowFirst = next.wordFirst = m_rows + m_words;
+    next.rowLast = next.wordLast = -1;
+
+    for (int y = rowFirst; y <= rowLast; ++y) {
+        const std::uint64_t *f = &m_frontier[(y + 1) * stride + 1];
+        const std::uint64_t *up = f - stride;
+        const std::uint64_t *down = f + stride;
+        const std::uint64_t *free = m_gameMap->freeRow(y);
+        std::uint64_t *visited = &m_visited[y * m_words];
+        std::uint64_t *out = &m_next[(y + 1) * stride + 1];
+        std::uint64_t rowBits = 0;
+
+        for (int w = wordFirst; w <= wordLast; ++w) {
+            const std::uint64_t reach = (f[w] << 1) | (f[w] >> 1) | (f[w - 1] >> 63)
+                    | (f[w + 1] << 63) | up[w] | down[w];
+            const std::uint64_t n = reach & free[w] & ~visited[w];
+            visited[w] |= n;
+            out[w] = n;
+            rowBits |= n;
+        }
+        if (!rowBits)
+            continue;
+
+        if (phase) {
+            std::uint64_t *marks = &m_phase[phase - 1][y * m_words];
+            for (int w = wordFirst; w <= wordLast; ++w)
+                marks[w] |= out[w];
+        }
+        for (int w = wordFirst; w <= wordLast; ++w) {
+            if (!out[w])
+                continue;
+            count += popCount(out[w]);
+            next.wordFirst = std::min(next.wordFirst, w);
+            next.wordLast = std::max(next.wordLast, w);
+        }
+        next.rowFirst = std::min(next.rowFirst, y);
+        next.rowLast = y;
+    }
+
+    // Clear current frontier, so buffer is zeroed outside of live layer
+    for (int y = cur.rowFirst; y <= cur.rowLast; ++y) {
+        std::uint64_t *row = &m_frontier[(y + 1) * stride + 1];
+        std::fill(row + cur.wordFirst, row + cur.wordLast + 1, 0);
+    }
+
+    if (count) {
+        m_dirty.rowFirst = std::min(m_dirty.rowFirst, next.rowFirst);
+        m_dirty.rowLast = std::max(m_dirty.rowLast, next.rowLast);
+        m_dirty.wordFirst = std::min(m_dirty.wordFirst, next.wordFirst);
+        m_dirty.wordLast = std::max(m_dirty.wordLast, next.wordLast);
+    }
+    return count;
+}
+
+/*!
+    Returns BFS distance modulo 3 of cell at \a x, \a y coordinates or -1 if cell is out of map
+    or wasn't visited.
+*/
+int BitBfsEngine::phase(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= m_gameMap->width() || y >= m_rows)
+        return -1;
+
+    const int word = y * m_words + x / 64;
+    const int bit = x % 64;
+    if (!((m_visited[word] >> bit) & 1))
+        return -1;
+    if ((m_phase[0][word] >> bit) & 1)
+        return 1;
+    if ((m_phase[1][word] >> bit) & 1)
+        return 2;
+    return 0;
+}
+
+/*!
+    Fills \a cells with path cells from \a start to \a finish (which is at \a length distance
+    from start) using distance marks of visited cells.
+*/
+void BitBfsEngine::reconstructPath(const Point &start, const Point &finish, int length,
+                                   std::vector<int> &cells) const
+{
+    const int dx[] = { -1, 1, 0, 0 };
+    const int dy[] = { 0, 0, -1, 1 };
+
+    cells.resize(length + 1);
+    cells[0] = m_gameMap->index(start);
+    cells[length] = m_gameMap->index(finish);
+
+    Point cur = finish;
+    for (int distance = length - 1; distance > 0; --distance) {
+        for (int k = 0; k < 4; ++k) {
+            if (phase(cur.x() + dx[k], cur.y() + dy[k]) == distance % 3) {
+                cur = Point(cur.x() + dx[k], cur.y() + dy[k]);
+                break;
+            }
+        }
+        cells[distance] = m_gameMap->index(cur);
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef BITBFSENGINE_H
+#define BITBFSENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "core/searchengine.h"
+
+class BitBfsEngine : public SearchEngine
+{
+public:
+    BitBfsEngine(const GameMap *gm, SearchContext *context);
+
+    bool findPath(const Point &start, const Point &finish, std::vector<int> &cells);
+    std::size_t memoryUsage() const;
+
+private:
+    struct Rect
+    {
+        int rowFirst, rowLast;   //!< Range of rows.
+        int wordFirst, wordLast; //!< Range of words in every row.
+    };
+
+    int m_rows;
+    int m_words;
+    std::vector<std::uint64_t> m_visited;
+    std::vector<std::uint64_t> m_phase[2]; //!< Distance modulo 3 (see class description).
+    std::vector<std::uint64_t> m_frontier;
+    std::vector<std::uint64_t> m_next;
+    Rect m_dirty; //!< Words of m_visited and m_phase that may be non-zero.
+
+    void prepare();
+    int expandLayer(const Rect &cur, int distance, Rect &next);
+    int phase(int x, int y) const;
+    void reconstructPath(const Point &start, const Point &finish, int length,
+                         std::vector<int> &cells) const;
+};
+
+#endif // BITBFSENGINE_H
@@ -0,0 +1,138 @@
+#ifndef BITBOARD128_H
+#define BITBOARD128_H
+
+#include <cstdint>
+
+/*!
+    \struct Bitboard128
+    \brief Set of up to 128 cells packed into two 64-bit words; bit n stands for cell n.
+
+    All the operations except bit scanning are constexpr, so masks built of bitboards can be
+    computed at compile time.
+
+    \note Shift operators accept only shift counts from range [1, 63].
+    \sa FixedBoard
+*/
+
+struct Bitboard128
+{
+    std::uint64_t lo; //!< Bits 0..63.
+    std::uint64_t hi; //!< Bits 64..127.
+
+    constexpr Bitboard128();
+    constexpr Bitboard128(std::uint64_t lo, std::uint64_t hi);
+
+    static constexpr Bitboard128 bit(int n);
+    static constexpr Bitboard128 lowBits(int n);
+
+    constexpr bool isEmpty() const;
+    constexpr bool test(int n) const;
+    int lowestBit() const;
+    int count() const;
+};
+
+/*!
+    Constructs empty bitboard.
+*/
+inline constexpr Bitboard128::Bitboard128()
+    : lo(0), hi(0)
+{
+}
+
+/*!
+    Constructs bitboard from words \a lo (bits 0..63) and \a hi (bits 64..127).
+*/
+inline constexpr Bitboard128::Bitboard128(std::uint64_t lo, std::uint64_t hi)
+    : lo(lo), hi(hi)
+{
+}
+
+/*!
+    Returns bitboard with the only bit \a n set.
+*/
+inline constexpr Bitboard128 Bitboard128::bit(int n)
+{
+    return n < 64 ? Bitboard128(std::uint64_t(1) << n, 0)
+                  : Bitboard128(0, std::uint64_t(1) << (n - 64));
+}
+
+/*!
+    Returns bitboard with bits [0, \a n) set.
+*/
+inline constexpr Bitboard128 Bitboard128::lowBits(int n)
+{
+    return n <= 0 ? Bitboard128()
+         : n < 64 ? Bitboard128((std::uint64_t(1) << n) - 1, 0)
+         : n == 64 ? Bitboard128(~std::uint64_t(0), 0)
+         : n < 128 ? Bitboard128(~std::uint64_t(0), (std::uint64_t(1) << (n - 64)) - 1)
+         : Bitboard128(~std::uint64_t(0), ~std::uint64_t(0));
+}
+
+/*!
+    Returns true if no bit is set.
+*/
+inline constexpr bool Bitboard128::isEmpty() const
+{
+    return !(lo | hi);
+}
+
+/*!
+    Returns true if bit \a n is set.
+*/
+inline constexpr bool Bitboard128::test(int n) const
+{
+    return n < 64 ? (lo >> n) & 1 : (hi >> (n - 64)) & 1;
+}
+
+/*!
+    Returns number of the lowest set bit; bitboard must not be empty.
+*/
+inline int Bitboard128::lowestBit() const
+{
+    return lo ? __builtin_ctzll(lo) : 64 + __builtin_ctzll(hi);
+}
+
+/*!
+    Returns count of set bits.
+*/
+inline int Bitboard128::count() const
+{
+    return __builtin_popcountll(lo) + __builtin_popcountll(hi);
+}
+
+inline constexpr Bitboard128 operator|(const Bitboard128 &a, const Bitboard128 &b)
+{
+    return Bitboard128(a.lo | b.lo, a.hi | b.hi);
+}
+
+inline constexpr Bitboard128 operator&(const Bitboard128 &a, const Bitboard128 &b)
+{
+    return Bitboard128(a.lo & b.lo, a.hi & b.hi);
+}
+
+inline constexpr Bitboard128 operator~(const Bitboard128 &a)
+{
+    return Bitboard128(~a.lo, ~a.hi);
+}
+
+inline constexpr Bitboard128 operator<<(const Bitboard128 &a, int n)
+{
+    return Bitboard128(a.lo << n, (a.hi << n) | (a.lo >> (64 - n)));
+}
+
+inline constexpr Bitboard128 operator>>(const Bitboard128 &a, int n)
+{
+    return Bitboard128((a.lo >> n) | (a.hi << (64 - n)), a.hi >> n);
+}
+
+inline constexpr bool operator==(const Bitboard128 &a, const Bitboard128 &b)
+{
+    return a.lo == b.lo && a.hi == b.hi;
+}
+
+inline constexpr bool operator!=(const Bitboard128 &a, const Bitboard128 &b)
+{
+    return !(a == b);
+}
+
+#endif // BITBOARD128_H
@@ -0,0 +1,191 @@
+#ifndef BUCKETQUEUE_H
+#define BUCKETQUEUE_H
+
+#include <cstddef>
+#include <vector>
+
+/*!
+    \class BucketQueue
+    \brief Bucket (Dial) priority queue of cell indices with small non-negative integer keys.
+
+    Queue keeps separate bucket for every key value, so push, pop (amortized) and
+    "decrease key" operations take O(1) time. Indices with equal keys are popped in LIFO
+    order, which makes A* prefer the most recently reached (i.e. the deepest) nodes among
+    nodes with equal f.
+
+    Has the same interface as IndexedHeap, so can be used as open list of A* algorithm.
+
+    \note Hot methods are defined in this header to let compiler inline them into search loop.
+    \sa IndexedHeap, PathFinder
+*/
+
+class BucketQueue
+{
+public:
+    BucketQueue();
+
+    void reserve(int indexCount);
+    void clear();
+    bool isEmpty() const;
+    int size() const;
+    bool contains(int index) const;
+    void push(int index, int key);
+    void decreaseKey(int index, int key);
+    int minKey();
+    int pop();
+    std::size_t memoryUsage() const;
+
+private:
+    std::vector<std::vector<int> > m_buckets;
+    std::vector<int> m_key;  //!< Key of each contained index or -1.
+    std::vector<int> m_slot; //!< Position of each contained index in its bucket.
+    int m_minKey;            //!< All buckets below this key are empty.
+    int m_maxKey;            //!< All buckets above this key are empty.
+    int m_size;
+
+    void remove(int index);
+};
+
+/*!
+    Constructs empty queue; call reserve() before pushing any index.
+*/
+inline BucketQueue::BucketQueue()
+    : m_minKey(0), m_maxKey(-1), m_size(0)
+{
+}
+
+/*!
+    Prepares queue for storing indices from range [0, \a indexCount) and makes queue empty.
+*/
+inline void BucketQueue::reserve(int indexCount)
+{
+    clear();
+    if (static_cast<int>(m_key.size()) != indexCount) {
+        m_key.assign(indexCount, -1);
+        m_slot.assign(indexCount, 0);
+    }
+}
+
+/*!
+    Removes all the indices from queue; takes time proportional to count of contained
+    indices plus range of their keys.
+*/
+inline void BucketQueue::clear()
+{
+    for (int k = m_minKey; k <= m_maxKey; ++k) {
+        std::vector<int> &bucket = m_buckets[k];
+        for (std::size_t i = 0; i < bucket.size(); ++i)
+            m_key[bucket[i]] = -1;
+        bucket.clear();
+    }
+    m_minKey = 0;
+    m_maxKey = -1;
+    m_size = 0;
+}
+
+/*!
+    Returns true if queue contains no indices.
+*/
+inline bool BucketQueue::isEmpty() const
+{
+    return m_size == 0;
+}
+
+/*!
+    Returns count of indices in queue.
+*/
+inline int BucketQueue::size() const
+{
+    return m_size;
+}
+
+/*!
+    Returns true if \a index is contained in queue.
+*/
+inline bool BucketQueue::contains(int index) const
+{
+    return m_key[index] >= 0;
+}
+
+/*!
+    Inserts \a index with non-negative key \a key into queue.
+    \note \a index must not be contained in queue.
+*/
+inline void BucketQueue::push(int index, int key)
+{
+    if (key >= static_cast<int>(m_buckets.size()))
+        m_buckets.resize(key + 1);
+    if (m_size == 0 || key < m_minKey)
+        m_minKey = key;
+    if (key > m_maxKey)
+        m_maxKey = key;
+
+    std::vector<int> &bucket = m_buckets[key];
+    m_slot[index] = static_cast<int>(bucket.size());
+    m_key[index] = key;
+    bucket.push_back(index);
+    ++m_size;
+}
+
+/*!
+    Sets key of contained \a index to \a key, which must not be greater than current key.
+*/
+inline void BucketQueue::decreaseKey(int index, int key)
+{
+    remove(index);
+    push(index, key);
+}
+
+/*!
+    Returns minimal key of contained indices.
+    \note Queue must not be empty.
+*/
+inline int BucketQueue::minKey()
+{
+    while (m_buckets[m_minKey].empty())
+        ++m_minKey;
+    return m_minKey;
+}
+
+/*!
+    Removes index with minimal key from queue and returns it.
+    \note Queue must not be empty.
+*/
+inline int BucketQueue::pop()
+{
+    while (m_buckets[m_minKey].empty())
+        ++m_minKey;
+
+    std::vector<int> &bucket = m_buckets[m_minKey];
+    int index = bucket.back();
+    bucket.pop_back();
+    m_key[index] = -1;
+    --m_size;
+    return index;
+}
+
+/*!
+    Returns count of bytes allocated by queue.
+*/
+inline std::size_t BucketQueue::memoryUsage() const
+{
+    std::size_t res = m_buckets.capacity() * sizeof(std::vector<int>);
+    for (std::size_t i = 0; i < m_buckets.size(); ++i)
+        res += m_buckets[i].capacity() * sizeof(int);
+    return res + (m_key.capacity() + m_slot.capacity()) * sizeof(int);
+}
+
+/* private */
+
+inline void BucketQueue::remove(int index)
+{
+    std::vector<int> &bucket = m_buckets[m_key[index]];
+    int last = bucket.back();
+    bucket[m_slot[index]] = last;
+    m_slot[last] = m_slot[index];
+    bucket.pop_back();
+    m_key[index] = -1;
+    --m_size;
+}
+
+#endif // BUCKETQUEUE_H
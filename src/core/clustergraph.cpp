@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <utility>
+#include "core/clustergraph.h"
+#include "core/gamemap.h"
+#include "util/math.h"
+
+namespace {
+    /*!
+        Border runs shorter than this get one entrance in the middle, longer ones get two
+        entrances at their ends (see ClusterGraph::SparseEntrances).
+    */
+    const int MaxSingleEntranceRun = 6;
+    const int TransitionCost = 1;
+} // anonymous namespace
+
+/*!
+    \class ClusterGraph
+    \brief Abstract graph of game map for hierarchical path finding (HPA*).
+
+    Game map is partitioned into square clusters of clusterSize() cells (clusters at the right
+    and bottom sides may be smaller). Every maximal run of empty cell pairs across the border
+    of two adjacent clusters is an entrance; entrance gets one or two transitions, i.e. pairs
+    of adjacent cells from both sides connected by abstract edge of one step. Cells of
+    transitions are nodes of abstract graph, and nodes of the same cluster are connected by
+    edges whose cost is length of the shortest path between them inside the cluster
+    (computed by breadth-first search at build time).
+
+    Entrance modes:
+      - SparseEntrances -- run shorter than 6 cells gets one transition in the middle, longer
+        one gets two transitions at its ends; abstract graph is small, but paths found
+        through it aren't always the shortest: every border crossing may detour to transition
+        up to clusterSize() cells away along the border and back. Ratio to the shortest
+        length has no constant bound and is the worst for short paths: at random maps up to
+        40x40 with clusters of 4 cells about 30% of paths are longer (1.16 times on average,
+        up to 3 times) and all the paths together are about 4% longer; with clusters of 16
+        cells it's about 10% of paths and 1.5% of length. Suboptimality of real queries is
+        reported by --stats option and by ballpath-bench;
+      - AllEntrances -- every empty cell pair across the border is a transition. Every path
+        of map is then a sequence of in-cluster segments and border crossings, each of which
+        has an edge of the same or smaller cost, so the shortest abstract path has exactly
+        the shortest length; graph is several times larger and takes longer to build.
+
+    Graph is stored in compressed form: nodes are numbered cluster by cluster, so nodes of
+    cluster are a contiguous range, and edges of all nodes are in one array.
+
+    Graph is built once per game map and is read-only afterwards, so it's shared by all the
+    searches; scratch of in-cluster searches (see searchCluster()) is provided by caller.
+
+    \sa GameMap::buildClusters(), HierarchicalEngine
+*/
+
+/*!
+    Constructs empty graph; call build() to make abstraction of game map.
+*/
+ClusterGraph::ClusterGraph()
+    : m_clusterSize(0), m_entranceMode(SparseEntrances), m_clustersX(0), m_clustersY(0)
+{
+}
+
+/*!
+    Builds abstract graph of game map \a gm with clusters of \a clusterSize x \a clusterSize
+    cells (at least 2) and entrances placed according to \a mode.
+*/
+void ClusterGraph::build(const GameMap &gm, int clusterSize, EntranceMode mode)
+{
+    clear();
+    m_clusterSize = Math::max(clusterSize, 2);
+    m_entranceMode = mode;
+    m_clustersX = (gm.width() + m_clusterSize - 1) / m_clusterSize;
+    m_clustersY = (gm.height() + m_clusterSize - 1) / m_clusterSize;
+
+    // Transitions (pairs of cells) of borders between horizontally and vertically adjacent
+    // clusters
+    std::vector<int> transitions;
+    for (int x = m_clusterSize - 1; x + 1 < gm.width(); x += m_clusterSize) {
+        for (int y = 0; y < gm.height(); y += m_clusterSize)
+            addEntrances(gm, x, y, 0, 1, Math::min(m_clusterSize, gm.height() - y), transitions);
+    }
+    for (int y = m_clusterSize - 1; y + 1 < gm.height(); y += m_clusterSize) {
+        for (int x = 0; x < gm.width(); x += m_clusterSize)
+            addEntrances(gm, x, y, 1, 0, Math::min(m_clusterSize, gm.width() - x), transitions);
+    }
+
+    // Nodes are numbered cluster by cluster; cell can belong to transitions of two borders
+    std::vector<std::pair<int, int> > cells; // (cluster, cell index)
+    cells.reserve(transitions.size());
+    for (int cell : transitions)
+        cells.push_back(std::make_pair(cluster(gm.point(cell)), cell));
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+    std::vector<int> cellNode(gm.indexCount(), -1);
+    m_clusterNodes.assign(clusterCount() + 1, 0);
+    m_nodeCell.resize(cells.size());
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+        m_nodeCell[i] = cells[i].second;
+        cellNode[cells[i].second] = static_cast<int>(i);
+        ++m_clusterNodes[cells[i].first + 1];
+    }
+    for (int c = 0; c < clusterCount(); ++c)
+        m_clusterNodes[c + 1] += m_clusterNodes[c];
+
+    // Edges: transitions in both directions and the shortest in-cluster paths
+    std::vector<std::pair<int, Edge> > edges;
+    for (std::size_t i = 0; i < transitions.size(); i += 2) {
+        const int node1 = cellNode[transitions[i]];
+        const int node2 = cellNode[transitions[i + 1]];
+        const Edge edge1 = { node2, TransitionCost };
+        const Edge edge2 = { node1, TransitionCost };
+        edges.push_back(std::make_pair(node1, edge1));
+        edges.push_back(std::make_pair(node2, edge2));
+    }
+    Scratch scratch;
+    std::vector<int> local; // local index of every node of cluster
+    for (int c = 0; c < clusterCount(); ++c) {
+        local.clear();
+        for (int node = firstNode(c); node < lastNode(c); ++node)
+            local.push_back(localIndex(gm, c, m_nodeCell[node]));
+        loadCluster(gm, c, scratch);
+        for (int node = firstNode(c); node < lastNode(c); ++node) {
+            searchLoaded(local[node - firstNode(c)], scratch);
+            for (int other = firstNode(c); other < lastNode(c); ++other) {
+                const int cost = scratch.distance[local[other - firstNode(c)]];
+                if (other != node && cost > 0) {
+                    const Edge edge = { other, cost };
+                    edges.push_back(std::make_pair(node, edge));
+                }
+            }
+        }
+    }
+
+    m_edgeBegin.assign(nodeCount() + 1, 0);
+    for (const std::pair<int, Edge> &edge : edges)
+        ++m_edgeBegin[edge.first + 1];
+    for (int node = 0; node < nodeCount(); ++node)
+        m_edgeBegin[node + 1] += m_edgeBegin[node];
+    m_edges.resize(edges.size());
+    std::vector<int> fill(m_edgeBegin.begin(), m_edgeBegin.end() - 1);
+    for (const std::pair<int, Edge> &edge : edges)
+        m_edges[fill[edge.first]++] = edge.second;
+}
+
+/*!
+    Drops abstract graph.
+*/
+void ClusterGraph::clear()
+{
+    m_clusterSize = 0;
+    m_clustersX = 0;
+    m_clustersY = 0;
+    std::vector<int>().swap(m_clusterNodes);
+    std::vector<int>().swap(m_nodeCell);
+    std::vector<int>().swap(m_edgeBegin);
+    std::vector<Edge>().swap(m_edges);
+}
+
+/*!
+    Returns true if graph wasn't built.
+*/
+bool ClusterGraph::isEmpty() const
+{
+    return m_clusterNodes.empty();
+}
+
+/*!
+    Returns size of cluster side in cells.
+*/
+int ClusterGraph::clusterSize() const
+{
+    return m_clusterSize;
+}
+
+/*!
+    Returns mode of placing entrances graph was built with.
+*/
+ClusterGraph::EntranceMode ClusterGraph::entranceMode() const
+{
+    return m_entranceMode;
+}
+
+/*!
+    Returns count of clusters; clusters are numbered row by row.
+*/
+int ClusterGraph::clusterCount() const
+{
+    return m_clustersX * m_clustersY;
+}
+
+/*!
+    Returns count of nodes (transition cells) of abstract graph.
+*/
+int ClusterGraph::nodeCount() const
+{
+    return static_cast<int>(m_nodeCell.size());
+}
+
+/*!
+    Returns count of directed edges of abstract graph.
+*/
+int ClusterGraph::edgeCount() const
+{
+    return static_cast<int>(m_edges.size());
+}
+
+/*!
+    Runs breadth-first search from cell with index \a source inside \a cluster of game map
+    \a gm and stores distances into \a scratch (see distance()). Source cell itself may be a
+    ball; search goes through empty cells only and never leaves the cluster.
+*/
+void ClusterGraph::searchCluster(const GameMap &gm, int cluster, int source,
+                                 Scratch &scratch) const
+{
+    loadCluster(gm, cluster, scratch);
+    searchLoaded(localIndex(gm, cluster, source), scratch);
+}
+
+/*!
+    Returns distance to cell with index \a cell found by last searchCluster() call for
+    \a cluster with \a scratch; it's negative if cell isn't reachable inside the cluster.
+*/
+int ClusterGraph::distance(const GameMap &gm, int cluster, int cell, const Scratch &scratch) const
+{
+    return scratch.distance[localIndex(gm, cluster, cell)];
+}
+
+/*!
+    Appends to \a cells indices of cells of the shortest path inside \a cluster from source of
+    last searchCluster() call (exclusive) to cell with index \a target (inclusive), which must
+    be reachable.
+*/
+void ClusterGraph::appendClusterPath(const GameMap &gm, int cluster, int target,
+                                     const Scratch &scratch, std::vector<int> &cells) const
+{
+    int left, top, width, height;
+    clusterRect(gm, cluster, left, top, width, height);
+    const std::vector<int> &distance = scratch.distance;
+    const int offsets[] = { -1, 1, -scratch.stride, scratch.stride };
+
+    const std::size_t begin = cells.size();
+    int cur = localIndex(gm, cluster, target);
+    for (int d = distance[cur]; d > 0; --d) {
+        cells.push_back(gm.index(left + cur % scratch.stride - 1, top + cur / scratch.stride - 1));
+        // Step to any neighbour which is one step closer to the source
+        for (int k = 0; k < 4; ++k) {
+            if (distance[cur + offsets[k]] == d - 1) {
+                cur += offsets[k];
+                break;
+            }
+        }
+    }
+    std::reverse(cells.begin() + begin, cells.end());
+}
+
+/*!
+    Returns count of bytes allocated for abstract graph.
+*/
+std::size_t ClusterGraph::memoryUsage() const
+{
+    return (m_clusterNodes.capacity() + m_nodeCell.capacity() + m_edgeBegin.capacity())
+            * sizeof(int) + m_edges.capacity() * sizeof(Edge);
+}
+
+/* private */
+
+/*!
+    Scans border segment of \a length cell pairs of game map \a gm, starting with cell at \a x,
+    \a y and going in direction \a dx, \a dy; the other cell of every pair is the next one
+    across the border (at \a dy, \a dx offset). Appends cell indices of transition pairs of
+    every run of empty pairs to \a transitions.
+*/
+void ClusterGraph::addEntrances(const GameMap &gm, int x, int y, int dx, int dy, int length,
+                                std::vector<int> &transitions) const
+{
+    int runStart = -1;
+    for (int i = 0; i <= length; ++i) {
+        const bool isFree = i < length && !gm.isWall(x + i * dx, y + i * dy)
+                && !gm.isWall(x + i * dx + dy, y + i * dy + dx);
+        if (isFree) {
+            if (runStart < 0)
+                runStart = i;
+            if (m_entranceMode == AllEntrances) {
+                transitions.push_back(gm.index(x + i * dx, y + i * dy));
+                transitions.push_back(gm.index(x + i * dx + dy, y + i * dy + dx));
+            }
+            continue;
+        }
+        if (runStart < 0 || m_entranceMode == AllEntrances) {
+            runStart = -1;
+            continue;
+        }
+
+        const int runLength = i - runStart;
+        int positions[2] = { runStart + runLength / 2, -1 };
+        if (runLength >= MaxSingleEntranceRun) {
+            positions[0] = runStart;
+            positions[1] = i - 1;
+        }
+        for (int position : positions) {
+            if (position < 0)
+                continue;
+            transitions.push_back(gm.index(x + position * dx, y + position * dy));
+            transitions.push_back(gm.index(x + position * dx + dy, y + position * dy + dx));
+        }
+        runStart = -1;
+    }
+}
+
+/*!
+    Copies walls of \a cluster of game map \a gm into \a scratch, framed by walls (like
+    GameMap itself), so that in-cluster searches neither call GameMap nor check bounds.
+*/
+void ClusterGraph::loadCluster(const GameMap &gm, int cluster, Scratch &scratch) const
+{
+    int left, top, width, height;
+    clusterRect(gm, cluster, left, top, width, height);
+
+    scratch.stride = width + 2;
+    scratch.walls.assign(scratch.stride * (height + 2), true);
+    for (int y = 0; y < height; ++y) {
+        const int base = gm.index(left, top + y);
+        char *walls = &scratch.walls[(y + 1) * scratch.stride + 1];
+        for (int x = 0; x < width; ++x)
+            walls[x] = gm.isWall(base + x);
+    }
+}
+
+/*!
+    Runs breadth-first search from cell with local index \a first over cluster loaded into
+    \a scratch by loadCluster().
+*/
+void ClusterGraph::searchLoaded(int first, Scratch &scratch) const
+{
+    const int count = static_cast<int>(scratch.walls.size());
+    const int offsets[] = { -1, 1, -scratch.stride, scratch.stride };
+    scratch.distance.resize(count);
+    scratch.queue.resize(count);
+
+    // Walls get distance -2 and unreached empty cells -1, so one comparison checks both
+    const char *walls = scratch.walls.data();
+    int *distance = scratch.distance.data();
+    for (int i = 0; i < count; ++i)
+        distance[i] = -1 - walls[i];
+
+    // Branchless: queue slot is always written but taken only for unreached empty cell
+    int *queue = scratch.queue.data();
+    int tail = 0;
+    distance[first] = 0;
+    queue[tail++] = first;
+    for (int head = 0; head < tail; ++head) {
+        const int cur = queue[head];
+        const int d = distance[cur] + 1;
+        for (int k = 0; k < 4; ++k) {
+            const int next = cur + offsets[k];
+            const bool isNew = distance[next] == -1;
+            distance[next] = isNew ? d : distance[next];
+            queue[tail] = next;
+            tail += isNew;
+        }
+    }
+}
+
+/*!
+    Returns index of cell with index \a cell of game map \a gm inside \a cluster loaded by
+    loadCluster() (row by row, including the frame).
+*/
+int ClusterGraph::localIndex(const GameMap &gm, int cluster, int cell) const
+{
+    int left, top, width, height;
+    clusterRect(gm, cluster, left, top, width, height);
+    const Point p = gm.point(cell);
+    return (p.y() - top + 1) * (width + 2) + p.x() - left + 1;
+}
+
+/*!
+    Stores coordinates of top left cell and size of \a cluster of game map \a gm into
+    \a left, \a top, \a width and \a height.
+*/
+void ClusterGraph::clusterRect(const GameMap &gm, int cluster, int &left, int &top, int &width,
+                               int &height) const
+{
+    left = cluster % m_clustersX * m_clusterSize;
+    top = cluster / m_clustersX * m_clusterSize;
+    width = Math::min(m_clusterSize, gm.width() - left);
+    height = Math::min(m_clusterSize, gm.height() - top);
+}
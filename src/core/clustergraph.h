@@ -0,0 +1,132 @@
+#ifndef CLUSTERGRAPH_H
+#define CLUSTERGRAPH_H
+
+#include <cstddef>
+#include <vector>
+#include "util/point.h"
+
+class GameMap;
+
+class ClusterGraph
+{
+public:
+    enum EntranceMode { SparseEntrances, AllEntrances };
+
+    /*!
+        \struct ClusterGraph::Edge
+        \brief Edge of abstract graph: target node and length of path to it in steps.
+    */
+    struct Edge
+    {
+        int node;
+        int cost;
+    };
+
+    /*!
+        \struct ClusterGraph::Scratch
+        \brief Scratch of searchCluster(); one per concurrent search.
+    */
+    struct Scratch
+    {
+        std::vector<char> walls;   //!< Walls of cluster with frame by local index.
+        std::vector<int> distance; //!< Distance by local index; negative if unreached.
+        std::vector<int> queue;
+        int stride;                //!< Difference between local indices of adjacent rows.
+
+        Scratch() : stride(0) {}
+    };
+
+    ClusterGraph();
+
+    void build(const GameMap &gm, int clusterSize, EntranceMode mode);
+    void clear();
+    bool isEmpty() const;
+
+    int clusterSize() const;
+    EntranceMode entranceMode() const;
+    int clusterCount() const;
+    int cluster(const Point &point) const;
+    int firstNode(int cluster) const;
+    int lastNode(int cluster) const;
+
+    int nodeCount() const;
+    int nodeCell(int node) const;
+    const Edge *edgesBegin(int node) const;
+    const Edge *edgesEnd(int node) const;
+    int edgeCount() const;
+
+    void searchCluster(const GameMap &gm, int cluster, int source, Scratch &scratch) const;
+    int distance(const GameMap &gm, int cluster, int cell, const Scratch &scratch) const;
+    void appendClusterPath(const GameMap &gm, int cluster, int target, const Scratch &scratch,
+                           std::vector<int> &cells) const;
+
+    std::size_t memoryUsage() const;
+
+private:
+    int m_clusterSize;
+    EntranceMode m_entranceMode;
+    int m_clustersX;
+    int m_clustersY;
+    std::vector<int> m_clusterNodes; //!< First node of every cluster (and node count at end).
+    std::vector<int> m_nodeCell;     //!< Cell index of every node.
+    std::vector<int> m_edgeBegin;    //!< First edge of every node (and edge count at end).
+    std::vector<Edge> m_edges;
+
+    void addEntrances(const GameMap &gm, int x, int y, int dx, int dy, int length,
+                      std::vector<int> &transitions) const;
+    void loadCluster(const GameMap &gm, int cluster, Scratch &scratch) const;
+    void searchLoaded(int first, Scratch &scratch) const;
+    int localIndex(const GameMap &gm, int cluster, int cell) const;
+    void clusterRect(const GameMap &gm, int cluster, int &left, int &top, int &width,
+                     int &height) const;
+};
+
+/*!
+    Returns cluster containing cell at \a point coordinates.
+*/
+inline int ClusterGraph::cluster(const Point &point) const
+{
+    return point.y() / m_clusterSize * m_clustersX + point.x() / m_clusterSize;
+}
+
+/*!
+    Returns first node of \a cluster; nodes of cluster are [firstNode(), lastNode()).
+*/
+inline int ClusterGraph::firstNode(int cluster) const
+{
+    return m_clusterNodes[cluster];
+}
+
+/*!
+    Returns node following the last node of \a cluster.
+*/
+inline int ClusterGraph::lastNode(int cluster) const
+{
+    return m_clusterNodes[cluster + 1];
+}
+
+/*!
+    Returns index of cell (see GameMap::index()) of \a node.
+*/
+inline int ClusterGraph::nodeCell(int node) const
+{
+    return m_nodeCell[node];
+}
+
+/*!
+    Returns first edge going out of \a node.
+*/
+inline const ClusterGraph::Edge *ClusterGraph::edgesBegin(int node) const
+{
+    return m_edges.data() + m_edgeBegin[node];
+}
+
+/*!
+    Returns pointer past the last edge going out of \a node.
+*/
+inline const ClusterGraph::Edge *ClusterGraph::edgesEnd(int node) const
+{
+    return m_edges.data() + m_edgeBegin[node + 1];
+}
+
+#endif // CLUSTERGRAPH_H
@@ -0,0 +1,373 @@
+#include <cstdint>
+#include <limits>
+#include "core/componentindex.h"
+#include "core/gamemap.h"
+
+namespace {
+    /*!
+        Returns root of piece \a piece in disjoint-set forest \a parent.
+    */
+    inline int findRoot(const int *parent, int piece)
+    {
+        while (parent[piece] != piece)
+            piece = parent[piece];
+        return piece;
+    }
+} // anonymous namespace
+
+/*!
+    \class ComponentIndex
+    \brief Labels connected components (regions) of empty cells of game map.
+
+    Two empty cells belong to the same component if a ball can be moved between them, so
+    cells of different components are never connected by a path. Labelling is built by one
+    flood fill pass over the map, in O(cells) time; afterwards component of any cell is
+    found in O(1) time.
+
+    Index is kept up to date incrementally as single cells change (see cellFreed() and
+    cellOccupied()), so the cost of update depends on the local change, not on map area:
+      - when cell becomes empty, components around it are merged: all but the largest one
+        are relabelled (so every cell is relabelled O(log cells) times at most);
+      - when ball is placed, its component may fall into up to four pieces: flood fills are
+        run from every neighbour of the cell in lockstep, pieces that meet are joined, and
+        search stops as soon as only one piece is still growing; only the pieces that were
+        completely enumerated (i.e. the smaller ones) get new components.
+
+    Component ids are reused, so they are not contiguous; all of them are less than
+    componentLimit().
+
+    \sa GameMap::buildComponents(), MoveGenerator
+*/
+
+/*!
+    Constructs empty index; call build() to label game map.
+*/
+ComponentIndex::ComponentIndex()
+    : m_stride(0), m_count(0), m_epoch(0)
+{
+}
+
+/*!
+    Labels connected components of empty cells of game map \a gm.
+*/
+void ComponentIndex::build(const GameMap &gm)
+{
+    const int offsets[4] = { -1, 1, -gm.rowStride(), gm.rowStride() };
+
+    m_stride = gm.rowStride();
+    m_count = 0;
+    m_component.assign(gm.indexCount(), -1);
+    m_size.clear();
+    m_freeIds.clear();
+
+    std::vector<int> &queue = m_pieces[0];
+    for (int y = 0; y < gm.height(); ++y) {
+        for (int x = 0; x < gm.width(); ++x) {
+            const int seed = gm.index(x, y);
+            if (gm.isWall(seed) || m_component[seed] >= 0)
+                continue;
+
+            const int component = newComponent();
+            m_component[seed] = component;
+            queue.assign(1, seed);
+            for (std::size_t head = 0; head < queue.size(); ++head) {
+                for (int i = 0; i < 4; ++i) {
+                    const int next = queue[head] + offsets[i];
+                    if (!gm.isWall(next) && m_component[next] < 0) {
+                        m_component[next] = component;
+                        queue.push_back(next);
+                    }
+                }
+            }
+            m_size[component] = static_cast<int>(queue.size());
+        }
+    }
+}
+
+/*!
+    Loads labelling of game map \a gm from \a labels: component of every cell row by row, -1
+    for walls (e.g. precomputed labelling stored in binary map file). It takes one pass over
+    \a labels without flood fill; labels are checked for consistency with walls of \a gm, but
+    not for connectivity.
+    \return false (and leaves index empty) if \a labels are inconsistent with \a gm.
+*/
+bool ComponentIndex::assign(const GameMap &gm, const std::int32_t *labels)
+{
+    const int limit = gm.width() * gm.height();
+
+    clear();
+    m_stride = gm.rowStride();
+    m_component.assign(gm.indexCount(), -1);
+    for (int y = 0; y < gm.height(); ++y) {
+        for (int x = 0; x < gm.width(); ++x) {
+            const int index = gm.index(x, y);
+            const int component = *labels++;
+            if (gm.isWall(index) ? component != -1 : component < 0 || component >= limit) {
+                clear();
+                return false;
+            }
+            if (component < 0)
+                continue;
+
+            if (component >= static_cast<int>(m_size.size()))
+                m_size.resize(component + 1, 0);
+            if (m_size[component]++ == 0)
+                ++m_count;
+            m_component[index] = component;
+        }
+    }
+
+    for (int component = 0; component < static_cast<int>(m_size.size()); ++component) {
+        if (m_size[component] == 0)
+            m_freeIds.push_back(component);
+    }
+    return true;
+}
+
+/*!
+    Makes index empty (as it was never built).
+*/
+void ComponentIndex::clear()
+{
+    m_count = 0;
+    m_component.clear();
+    m_size.clear();
+    m_freeIds.clear();
+    m_mark.clear();
+}
+
+/*!
+    Returns true if index wasn't built.
+*/
+bool ComponentIndex::isEmpty() const
+{
+    return m_component.empty();
+}
+
+/*!
+    Updates index after cell with index \a index of game map \a gm became empty.
+*/
+void ComponentIndex::cellFreed(const GameMap &gm, int index)
+{
+    const int offsets[4] = { -1, 1, -gm.rowStride(), gm.rowStride() };
+
+    // The largest adjacent component absorbs the others
+    int target = -1;
+    for (int i = 0; i < 4; ++i) {
+        const int component = m_component[index + offsets[i]];
+        if (component >= 0 && (target < 0 || m_size[component] > m_size[target]))
+            target = component;
+    }
+    if (target < 0)
+        target = newComponent();
+
+    for (int i = 0; i < 4; ++i) {
+        const int next = index + offsets[i];
+        const int component = m_component[next];
+        if (component < 0 || component == target)
+            continue;
+        m_size[target] += m_size[component];
+        m_size[component] = 0;
+        m_freeIds.push_back(component);
+        --m_count;
+        relabel(next, component, target);
+    }
+
+    m_component[index] = target;
+    ++m_size[target];
+}
+
+/*!
+    Updates index after cell with index \a index of game map \a gm became wall (ball).
+*/
+void ComponentIndex::cellOccupied(const GameMap &gm, int index)
+{
+    const int offsets[4] = { -1, 1, -gm.rowStride(), gm.rowStride() };
+    const int component = m_component[index];
+    m_component[index] = -1;
+    if (--m_size[component] == 0) {
+        m_freeIds.push_back(component);
+        --m_count;
+        return;
+    }
+
+    // All the empty neighbours belong to the component; every one starts its own piece
+    int pieceCount = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (m_component[index + offsets[i]] == component)
+            m_pieces[pieceCount++].assign(1, index + offsets[i]);
+    }
+    if (pieceCount < 2)
+        return;
+
+    nextEpoch();
+    const unsigned base = m_epoch * MaxPieces;
+    int parent[MaxPieces];
+    std::size_t head[MaxPieces];
+    for (int p = 0; p < pieceCount; ++p) {
+        parent[p] = p;
+        head[p] = 0;
+        m_mark[m_pieces[p][0]] = base + p;
+    }
+
+    for (;;) {
+        // Pieces that met each other are joined; piece is growing if any of its fills is
+        bool isRoot[MaxPieces] = { false };
+        bool isGrowing[MaxPieces] = { false };
+        for (int p = 0; p < pieceCount; ++p) {
+            const int root = findRoot(parent, p);
+            isRoot[root] = true;
+            isGrowing[root] = isGrowing[root] || head[p] < m_pieces[p].size();
+        }
+        int roots = 0;
+        int growing = 0;
+        for (int p = 0; p < pieceCount; ++p) {
+            roots += isRoot[p];
+            growing += isGrowing[p];
+        }
+        if (roots == 1)
+            return; // component is still connected
+        if (growing <= 1)
+            break;
+
+        for (int p = 0; p < pieceCount; ++p) {
+            if (head[p] == m_pieces[p].size())
+                continue;
+            const int cur = m_pieces[p][head[p]++];
+            for (int i = 0; i < 4; ++i) {
+                const int next = cur + offsets[i];
+                if (m_component[next] != component)
+                    continue;
+                if (m_mark[next] < base) {
+                    m_mark[next] = base + p;
+                    m_pieces[p].push_back(next);
+                    continue;
+                }
+                const int a = findRoot(parent, p);
+                const int b = findRoot(parent, static_cast<int>(m_mark[next] - base));
+                if (a != b)
+                    parent[b] = a;
+            }
+        }
+    }
+
+    // Find piece which keeps the component: the growing one or the largest one
+    int keeper = -1;
+    int sizes[MaxPieces] = { 0 };
+    for (int p = 0; p < pieceCount; ++p) {
+        const int root = findRoot(parent, p);
+        parent[p] = root;
+        sizes[root] += static_cast<int>(m_pieces[p].size());
+        if (head[p] < m_pieces[p].size())
+            keeper = root;
+    }
+    if (keeper < 0) {
+        keeper = parent[0];
+        for (int p = 0; p < pieceCount; ++p) {
+            if (sizes[p] > sizes[keeper])
+                keeper = p;
+        }
+    }
+
+    // The rest of pieces were enumerated completely, so they are relabelled as is
+    for (int root = 0; root < pieceCount; ++root) {
+        if (root == keeper || parent[root] != root)
+            continue;
+        const int piece = newComponent();
+        for (int p = 0; p < pieceCount; ++p) {
+            if (parent[p] != root)
+                continue;
+            for (std::size_t i = 0; i < m_pieces[p].size(); ++i)
+                m_component[m_pieces[p][i]] = piece;
+        }
+        m_size[piece] = sizes[root];
+        m_size[component] -= sizes[root];
+    }
+}
+
+/*!
+    Returns count of connected components.
+*/
+int ComponentIndex::componentCount() const
+{
+    return m_count;
+}
+
+/*!
+    Returns upper bound of component ids: all of them are less than returned value.
+*/
+int ComponentIndex::componentLimit() const
+{
+    return static_cast<int>(m_size.size());
+}
+
+/*!
+    Returns count of cells in component \a component.
+*/
+int ComponentIndex::componentSize(int component) const
+{
+    return m_size[component];
+}
+
+/*!
+    Returns count of bytes allocated for index.
+*/
+std::size_t ComponentIndex::memoryUsage() const
+{
+    std::size_t pieces = 0;
+    for (int p = 0; p < MaxPieces; ++p)
+        pieces += m_pieces[p].capacity();
+    return (m_component.capacity() + m_size.capacity() + m_freeIds.capacity() + pieces)
+            * sizeof(int) + m_mark.capacity() * sizeof(unsigned);
+}
+
+/* private */
+
+/*!
+    Allocates id for new empty component.
+*/
+int ComponentIndex::newComponent()
+{
+    ++m_count;
+    if (m_freeIds.empty()) {
+        m_size.push_back(0);
+        return static_cast<int>(m_size.size()) - 1;
+    }
+    const int component = m_freeIds.back();
+    m_freeIds.pop_back();
+    return component;
+}
+
+/*!
+    Moves all the cells of component \a from connected with cell \a seed to component \a to.
+*/
+void ComponentIndex::relabel(int seed, int from, int to)
+{
+    const int offsets[4] = { -1, 1, -m_stride, m_stride };
+    std::vector<int> &queue = m_pieces[0];
+
+    m_component[seed] = to;
+    queue.assign(1, seed);
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        for (int i = 0; i < 4; ++i) {
+            const int next = queue[head] + offsets[i];
+            if (m_component[next] == from) {
+                m_component[next] = to;
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
+/*!
+    Starts new epoch of visited cells marks, so all the cells become unvisited.
+*/
+void ComponentIndex::nextEpoch()
+{
+    if (m_mark.size() != m_component.size()
+            || m_epoch >= std::numeric_limits<unsigned>::max() / MaxPieces - 1) {
+        m_mark.assign(m_component.size(), 0);
+        m_epoch = 0;
+    }
+    ++m_epoch;
+}
@@ -0,0 +1,83 @@
+#ifndef COMPONENTINDEX_H
+#define COMPONENTINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class GameMap;
+
+class ComponentIndex
+{
+public:
+    ComponentIndex();
+
+    void build(const GameMap &gm);
+    bool assign(const GameMap &gm, const std::int32_t *labels);
+    void clear();
+    bool isEmpty() const;
+
+    void cellFreed(const GameMap &gm, int index);
+    void cellOccupied(const GameMap &gm, int index);
+
+    int componentCount() const;
+    int componentLimit() const;
+    int component(int index) const;
+    int componentSize(int component) const;
+    bool isConnected(int index1, int index2) const;
+    bool isReachable(int start, int finish) const;
+
+    std::size_t memoryUsage() const;
+
+private:
+    enum { MaxPieces = 4 }; //!< Count of neighbours of a cell.
+
+    int m_stride;
+    int m_count;
+    std::vector<int> m_component; //!< Component of every cell index or -1 for walls.
+    std::vector<int> m_size;      //!< Count of cells of every component id (0 if id is free).
+    std::vector<int> m_freeIds;
+
+    // Scratch for incremental updates
+    unsigned m_epoch;
+    std::vector<unsigned> m_mark;               //!< Epoch * MaxPieces + piece of visited cells.
+    std::vector<int> m_pieces[MaxPieces];       //!< Cells visited from every neighbour.
+
+    int newComponent();
+    void relabel(int seed, int from, int to);
+    void nextEpoch();
+};
+
+/*!
+    Returns component of cell with index \a index or -1 if cell is wall.
+*/
+inline int ComponentIndex::component(int index) const
+{
+    return m_component[index];
+}
+
+/*!
+    Returns true if cells with indices \a index1 and \a index2 are empty and belong to the
+    same component.
+*/
+inline bool ComponentIndex::isConnected(int index1, int index2) const
+{
+    return m_component[index1] >= 0 && m_component[index1] == m_component[index2];
+}
+
+/*!
+    Returns true if empty cell with index \a finish can be reached from cell with index
+    \a start, i.e. if \a start (usually ball) or one of its neighbours belongs to the same
+    component as \a finish.
+*/
+inline bool ComponentIndex::isReachable(int start, int finish) const
+{
+    const int component = m_component[finish];
+    return component >= 0
+            && (m_component[start] == component
+                || m_component[start - 1] == component || m_component[start + 1] == component
+                || m_component[start - m_stride] == component
+                || m_component[start + m_stride] == component);
+}
+
+#endif // COMPONENTINDEX_H
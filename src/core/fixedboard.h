@@ -0,0 +1,227 @@
+#ifndef FIXEDBOARD_H
+#define FIXEDBOARD_H
+
+#include <cstdint>
+#include "core/bitboard128.h"
+
+/*!
+    \class FixedBoard
+    \brief Game board of compile-time size \a Width x \a Height stored as one Bitboard128.
+
+    Cell at x, y coordinates is bit (y * Width + x) of the bitboard; set bit means empty
+    cell. Since board size is known at compile time, all the masks used for moving cells
+    between columns and rows are constexpr and folded into immediate operands.
+
+    Search runs breadth-first over whole layers: next layer is obtained from current one by
+    four shifts, masked by empty unvisited cells. Layers are kept in a fixed-size array on
+    the stack, so searches do no heap allocation at all. Shortest path is then restored
+    backwards from finish cell, picking at each step any neighbour from previous layer.
+
+    The main instance is ColorLinesBoard (9x9, 81 cells), see ColorLinesEngine.
+
+    \sa Bitboard128, FixedBoardEngine
+*/
+
+template <int Width, int Height>
+class FixedBoard
+{
+    static_assert(Width > 0 && Width < 64, "board row must fit 64-bit word");
+    static_assert(Height > 0 && Width * Height <= 128, "board must fit 128-bit bitboard");
+
+public:
+    enum { CellCount = Width * Height };
+
+    constexpr FixedBoard();
+    explicit constexpr FixedBoard(const Bitboard128 &freeCells);
+
+    static constexpr int cell(int x, int y);
+    static constexpr Bitboard128 allCells();
+    static constexpr Bitboard128 neighbours(const Bitboard128 &cells);
+
+    Bitboard128 freeCells() const;
+    bool isWall(int x, int y) const;
+    void setWall(int x, int y, bool isWall);
+    void setRow(int y, std::uint64_t freeBits);
+
+    Bitboard128 reachable(int start) const;
+    int findPath(int start, int finish, int *cells, int *expandedCount = 0) const;
+
+private:
+    Bitboard128 m_free;
+
+    static constexpr Bitboard128 columnCells(int x, int y = 0);
+    static constexpr Bitboard128 rowCells(int y);
+};
+
+typedef FixedBoard<9, 9> ColorLinesBoard;
+
+/*!
+    Constructs board where all the cells are walls.
+*/
+template <int Width, int Height>
+inline constexpr FixedBoard<Width, Height>::FixedBoard()
+{
+}
+
+/*!
+    Constructs board where empty cells are \a freeCells.
+*/
+template <int Width, int Height>
+inline constexpr FixedBoard<Width, Height>::FixedBoard(const Bitboard128 &freeCells)
+    : m_free(freeCells & allCells())
+{
+}
+
+/*!
+    Returns number of cell at \a x, \a y coordinates.
+*/
+template <int Width, int Height>
+inline constexpr int FixedBoard<Width, Height>::cell(int x, int y)
+{
+    return y * Width + x;
+}
+
+/*!
+    Returns mask of all the board cells.
+*/
+template <int Width, int Height>
+inline constexpr Bitboard128 FixedBoard<Width, Height>::allCells()
+{
+    return Bitboard128::lowBits(CellCount);
+}
+
+/*!
+    Returns cells adjacent (by side) to any of \a cells.
+*/
+template <int Width, int Height>
+inline constexpr Bitboard128 FixedBoard<Width, Height>::neighbours(const Bitboard128 &cells)
+{
+    // Shift by one moves cells of edge columns to the opposite edge of adjacent row
+    return (((cells << 1) & ~columnCells(0)) | ((cells >> 1) & ~columnCells(Width - 1))
+            | (cells << Width) | (cells >> Width)) & allCells();
+}
+
+/*!
+    Returns mask of empty cells.
+*/
+template <int Width, int Height>
+inline Bitboard128 FixedBoard<Width, Height>::freeCells() const
+{
+    return m_free;
+}
+
+/*!
+    Returns true if cell at \a x, \a y coordinates is wall (ball).
+*/
+template <int Width, int Height>
+inline bool FixedBoard<Width, Height>::isWall(int x, int y) const
+{
+    return !m_free.test(cell(x, y));
+}
+
+/*!
+    Makes cell at \a x, \a y coordinates wall (ball) if \a isWall is true or empty otherwise.
+*/
+template <int Width, int Height>
+inline void FixedBoard<Width, Height>::setWall(int x, int y, bool isWall)
+{
+    const Bitboard128 bit = Bitboard128::bit(cell(x, y));
+    m_free = isWall ? m_free & ~bit : m_free | bit;
+}
+
+/*!
+    Replaces row \a y by \a freeBits, where bit x is set if cell at x, \a y is empty (the
+    same layout as GameMap::freeRow()).
+*/
+template <int Width, int Height>
+inline void FixedBoard<Width, Height>::setRow(int y, std::uint64_t freeBits)
+{
+    const int pos = y * Width;
+    freeBits &= (std::uint64_t(1) << Width) - 1;
+    const Bitboard128 row = pos == 0 ? Bitboard128(freeBits, 0)
+                          : pos < 64 ? Bitboard128(freeBits << pos, freeBits >> (64 - pos))
+                          : Bitboard128(0, freeBits << (pos - 64));
+    m_free = (m_free & ~rowCells(y)) | row;
+}
+
+/*!
+    Returns empty cells reachable from cell \a start; start cell itself needn't be empty.
+*/
+template <int Width, int Height>
+inline Bitboard128 FixedBoard<Width, Height>::reachable(int start) const
+{
+    Bitboard128 visited = Bitboard128::bit(start);
+    Bitboard128 frontier = visited;
+    for (;;) {
+        frontier = neighbours(frontier) & m_free & ~visited;
+        if (frontier.isEmpty())
+            return visited & m_free;
+        visited = visited | frontier;
+    }
+}
+
+/*!
+    Finds shortest path from cell \a start (needn't be empty) to empty cell \a finish.
+    \param cells Receives path cells from \a start to \a finish inclusive; must have room
+    for CellCount items.
+    \param expandedCount If not null, receives count of cells reached by search.
+    \return Count of steps in found path or -1 if there is no path.
+*/
+template <int Width, int Height>
+int FixedBoard<Width, Height>::findPath(int start, int finish, int *cells,
+                                         int *expandedCount) const
+{
+    Bitboard128 layers[CellCount];
+    Bitboard128 visited = Bitboard128::bit(start);
+    Bitboard128 frontier = visited;
+    const Bitboard128 target = Bitboard128::bit(finish) & m_free;
+    int distance = 0;
+
+    if (start != finish) {
+        for (;;) {
+            frontier = neighbours(frontier) & m_free & ~visited;
+            if (frontier.isEmpty() || target.isEmpty()) {
+                if (expandedCount)
+                    *expandedCount = visited.count();
+                return -1;
+            }
+            layers[++distance] = frontier;
+            visited = visited | frontier;
+            if (!(frontier & target).isEmpty())
+                break;
+        }
+    }
+    if (expandedCount)
+        *expandedCount = visited.count();
+
+    cells[0] = start;
+    cells[distance] = finish;
+    for (int i = distance - 1; i > 0; --i) {
+        const Bitboard128 prev = neighbours(Bitboard128::bit(cells[i + 1])) & layers[i];
+        cells[i] = prev.lowestBit();
+    }
+    return distance;
+}
+
+/* private */
+
+/*!
+    Returns mask of cells of column \a x in rows [\a y, Height).
+*/
+template <int Width, int Height>
+inline constexpr Bitboard128 FixedBoard<Width, Height>::columnCells(int x, int y)
+{
+    return y == Height ? Bitboard128()
+                       : Bitboard128::bit(cell(x, y)) | columnCells(x, y + 1);
+}
+
+/*!
+    Returns mask of cells of row \a y.
+*/
+template <int Width, int Height>
+inline constexpr Bitboard128 FixedBoard<Width, Height>::rowCells(int y)
+{
+    return Bitboard128::lowBits(cell(0, y + 1)) & ~Bitboard128::lowBits(cell(0, y));
+}
+
+#endif // FIXEDBOARD_H
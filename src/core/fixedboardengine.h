@@ -0,0 +1,74 @@
+#ifndef FIXEDBOARDENGINE_H
+#define FIXEDBOARDENGINE_H
+
+#include "core/fixedboard.h"
+#include "core/searchengine.h"
+
+/*!
+    \class FixedBoardEngine
+    \brief Search engine for game maps of exactly \a Width x \a Height size.
+
+    Copies game map into FixedBoard (one packed word per row) and runs its stack-only
+    breadth-first search, so the only heap memory touched by search is \a cells vector
+    capacity, which is reused between searches.
+
+    PathFinder uses ColorLinesEngine automatically for 9x9 maps (see PathFinder::Auto).
+
+    \sa FixedBoard
+*/
+
+template <int Width, int Height>
+class FixedBoardEngine : public SearchEngine
+{
+public:
+    typedef FixedBoard<Width, Height> Board;
+
+    FixedBoardEngine(const GameMap *gm, SearchContext *context);
+
+    static bool accepts(const GameMap *gm);
+    bool findPath(const Point &start, const Point &finish, std::vector<int> &cells);
+};
+
+typedef FixedBoardEngine<9, 9> ColorLinesEngine;
+
+/*!
+    Constructs engine for searching paths at game map \a gm; \a context isn't used.
+*/
+template <int Width, int Height>
+inline FixedBoardEngine<Width, Height>::FixedBoardEngine(const GameMap *gm,
+                                                         SearchContext *context)
+    : SearchEngine(gm, context)
+{
+}
+
+/*!
+    Returns true if engine can search paths at game map \a gm (i.e. map has engine size).
+*/
+template <int Width, int Height>
+inline bool FixedBoardEngine<Width, Height>::accepts(const GameMap *gm)
+{
+    return gm->width() == Width && gm->height() == Height;
+}
+
+template <int Width, int Height>
+bool FixedBoardEngine<Width, Height>::findPath(const Point &start, const Point &finish,
+                                               std::vector<int> &cells)
+{
+    Board board;
+    for (int y = 0; y < Height; ++y)
+        board.setRow(y, *m_gameMap->freeRow(y));
+
+    int path[Board::CellCount];
+    const int length = board.findPath(Board::cell(start.x(), start.y()),
+                                      Board::cell(finish.x(), finish.y()),
+                                      path, &m_expandedCount);
+    cells.clear();
+    if (length < 0)
+        return false;
+
+    for (int i = 0; i <= length; ++i)
+        cells.push_back(m_gameMap->index(path[i] % Width, path[i] / Width));
+    return true;
+}
+
+#endif // FIXEDBOARDENGINE_H
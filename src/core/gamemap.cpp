@@ -1,71 +1,104 @@
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 #include "core/gamemap.h"
 #include "util/math.h"
 
+namespace {
+
+// Cells of byte grid for every combination of 8 bits of packed row
+struct WallBytesTable
+{
+    char bytes[256][8];
+
+    WallBytesTable()
+    {
+        for (int bits = 0; bits < 256; ++bits)
+            for (int i = 0; i < 8; ++i)
+                bytes[bits][i] = !((bits >> i) & 1);
+    }
+};
+
+const WallBytesTable WallBytes;
+
+} // anonymous namespace
+
 /*!
     \class GameMap
-    \brief Represents game map as two-dimensions array of nodes.
-    \sa Node, PathFinder
+    \brief Represents game map as flat two-dimensions array of cells.
+
+    Cells are stored contiguously, row by row, and surrounded by a one-cell frame of walls.
+    Every cell is addressed by its index (see index()), so the neighbours of a cell are
+    found by index arithmetic: -1 and +1 for left and right, -rowStride() and +rowStride()
+    for up and down. The frame guarantees that the neighbour of any inner cell is a valid
+    index, so search algorithms don't need to check map bounds.
+
+    Besides, game map keeps the same cells packed as bit rows (see freeRow()), where set bit
+    means empty cell; this representation is used by word-parallel search algorithms.
+
+    Optionally game map keeps labelling of connected components of empty cells (see
+    buildComponents()), which lets PathFinder reject unreachable finish points without search.
+    Labelling is updated incrementally on every cell change, so game can be played by
+    placeBall(), removeBall() and moveBall() without rebuilding it.
+
+    Game map can also keep abstract graph for hierarchical search (see buildClusters()) and
+    distance tables of landmarks for A* heuristic (see buildLandmarks()). They're meant for
+    static maps receiving many queries, so they aren't updated: any cell change drops them.
+
+    \sa PathFinder
 */
 
 /*!
     Constructs empty game map; to resize it later use method \a resize().
 */
 GameMap::GameMap()
+    : m_stride(0), m_rowWords(0)
 {
 }
 
 /*!
-    Constructs game map with size \a size and links all the nodes with their neighbours at once.
+    Constructs game map with size \a size; all the cells are empty.
 */
 GameMap::GameMap(const Size &size)
-    : m_size(size)
+    : m_stride(0), m_rowWords(0)
 {
     resize(size);
 }
 
 /*!
-    Constructs game map with size \a width, \a height and links all the nodes with their neighbours
-    at once.
+    Constructs game map with size \a width, \a height; all the cells are empty.
 */
 GameMap::GameMap(int width, int height)
-    : m_size(width, height)
-{
-    resize(m_size);
-}
-
-GameMap::~GameMap()
+    : m_stride(0), m_rowWords(0)
 {
-    for (auto v : m_map)
-        delete v;
+    resize(Size(width, height));
 }
 
 /*!
-    Resizes game map area to \a size and relinks all the nodes with their neighbours.
+    Resizes game map area to \a size; all the cells become empty.
 */
 void GameMap::resize(const Size &size)
 {
+    m_components.clear();
+    m_clusters.clear();
+    m_landmarks.clear();
     m_size = size;
-    for (auto v : m_map)
-        delete v;
-    m_map.resize(size.area());
+    m_stride = size.width() + 2;
+    m_rowWords = (size.width() + 63) / 64;
 
-    for (int j = 0; j < size.height(); ++j)
-        for (int i = 0; i < size.width(); ++i)
-            m_map[Math::calcIndex(i, j, m_size.width())] = new Node(i, j);
-
-    // Linking
+    // Only the frame is walls
+    m_walls.assign((size.width() + 2) * (size.height() + 2), false);
+    std::fill(m_walls.begin(), m_walls.begin() + m_stride, true);
+    std::fill(m_walls.end() - m_stride, m_walls.end(), true);
     for (int j = 0; j < size.height(); ++j) {
-        for (int i = 0; i < size.width(); ++i) {
-            if (i > 0)
-                at(i, j)->l = at(i - 1, j);
-            if (i < size.width() - 1)
-                at(i, j)->r = at(i + 1, j);
-            if (j > 0)
-                at(i, j)->u = at(i, j - 1);
-            if (j < size.height() - 1)
-                at(i, j)->d = at(i, j + 1);
-        }
+        m_walls[index(-1, j)] = true;
+        m_walls[index(size.width(), j)] = true;
+    }
+
+    m_freeBits.assign(m_rowWords * size.height(), ~std::uint64_t(0));
+    if (size.width() % 64) {
+        const std::uint64_t lastWord = (std::uint64_t(1) << (size.width() % 64)) - 1;
+        for (int j = 0; j < size.height(); ++j)
+            m_freeBits[(j + 1) * m_rowWords - 1] = lastWord;
     }
 }
 
@@ -78,51 +111,313 @@ Size GameMap::size() const
 }
 
 /*!
-    Returns node in game map that placed at \a x, \a y coordinates.
-    \note This method is constant.
+    Returns the width dimension of game map (that also available through size().width()).
 */
-const Node * const GameMap::at(int x, int y) const
+int GameMap::width() const
 {
-    return m_map.at(Math::calcIndex(x, y, m_size.width()));
+    return m_size.width();
 }
 
 /*!
-    Returns node in game map that placed at \a point coordinates.
-    \note This method is constant.
+    Returns the height dimension of game map (that also available through size().height()).
 */
-const Node * const GameMap::at(const Point &point) const
+int GameMap::height() const
 {
-    return m_map.at(Math::calcIndex(point.x(), point.y(), m_size.width()));
+    return m_size.height();
 }
 
 /*!
-    Returns node in game map that placed at \a x, \a y coordinates.
+    Returns true if cell at \a x, \a y coordinates is wall (ball).
 */
-Node * const GameMap::at(int x, int y)
+bool GameMap::isWall(int x, int y) const
 {
-    return m_map[Math::calcIndex(x, y, m_size.width())];
+    return m_walls[index(x, y)];
 }
 
 /*!
-    Returns node in game map that placed at \a point coordinates.
+    Returns true if cell at \a point coordinates is wall (ball).
 */
-Node * const GameMap::at(const Point &point)
+bool GameMap::isWall(const Point &point) const
 {
-    return m_map[Math::calcIndex(point.x(), point.y(), m_size.width())];
+    return m_walls[index(point)];
 }
 
 /*!
-    Returns the width dimension of game map (that also available through size().width()).
+    Returns true if cell with index \a index is wall (ball).
+    Cells of the frame around the map are always walls.
 */
-int GameMap::width() const
+bool GameMap::isWall(int index) const
 {
-    return m_size.width();
+    return m_walls[index];
 }
 
 /*!
-    Returns the height dimension of game map (that also available through size().height()).
+    Makes cell at \a x, \a y coordinates wall (ball) if \a isWall is true or empty otherwise.
 */
-int GameMap::height() const
+void GameMap::setWall(int x, int y, bool isWall)
 {
-    return m_size.height();
+    const int i = index(x, y);
+    const bool isChanged = static_cast<bool>(m_walls[i]) != isWall;
+    m_walls[i] = isWall;
+
+    std::uint64_t &word = m_freeBits[y * m_rowWords + x / 64];
+    const std::uint64_t bit = std::uint64_t(1) << (x % 64);
+    if (isWall)
+        word &= ~bit;
+    else
+        word |= bit;
+
+    if (isChanged && !m_clusters.isEmpty())
+        m_clusters.clear();
+    if (isChanged && !m_landmarks.isEmpty())
+        m_landmarks.clear();
+    if (isChanged && !m_components.isEmpty()) {
+        if (isWall)
+            m_components.cellOccupied(*this, i);
+        else
+            m_components.cellFreed(*this, i);
+    }
+}
+
+/*!
+    Makes cell at \a point coordinates wall (ball) if \a isWall is true or empty otherwise.
+*/
+void GameMap::setWall(const Point &point, bool isWall)
+{
+    setWall(point.x(), point.y(), isWall);
+}
+
+/*!
+    Sets the whole row \a y from \a freeBits packed as freeRow() (rowWords() words; set bit
+    means empty cell, bits beyond map width must be zero). It's much faster than setWall()
+    per cell; labelling of connected components, abstract graph and landmark tables (if they
+    were built) are dropped.
+*/
+void GameMap::setRow(int y, const std::uint64_t *freeBits)
+{
+    m_components.clear();
+    m_clusters.clear();
+    m_landmarks.clear();
+    std::copy(freeBits, freeBits + m_rowWords, m_freeBits.begin() + y * m_rowWords);
+
+    char *walls = &m_walls[index(0, y)];
+    const int width = m_size.width();
+    int i = 0;
+    for (; i + 8 <= width; i += 8)
+        std::memcpy(walls + i, WallBytes.bytes[(freeBits[i / 64] >> (i % 64)) & 0xff], 8);
+    for (; i < width; ++i)
+        walls[i] = !((freeBits[i / 64] >> (i % 64)) & 1);
+}
+
+/*!
+    Places ball to empty cell at \a point coordinates.
+    \return false if cell isn't empty.
+*/
+bool GameMap::placeBall(const Point &point)
+{
+    if (isWall(point))
+        return false;
+    setWall(point, true);
+    return true;
+}
+
+/*!
+    Removes ball from cell at \a point coordinates.
+    \return false if there is no ball at the cell.
+*/
+bool GameMap::removeBall(const Point &point)
+{
+    if (!isWall(point))
+        return false;
+    setWall(point, false);
+    return true;
+}
+
+/*!
+    Moves ball from cell at \a from coordinates to empty cell at \a to coordinates; path
+    between cells isn't checked.
+    \return false if there is no ball at \a from cell or \a to cell isn't empty.
+*/
+bool GameMap::moveBall(const Point &from, const Point &to)
+{
+    if (!isWall(from) || isWall(to))
+        return false;
+    setWall(from, false);
+    setWall(to, true);
+    return true;
+}
+
+/*!
+    Returns index of cell at \a x, \a y coordinates.
+    \sa point()
+*/
+int GameMap::index(int x, int y) const
+{
+    return Math::calcIndex(x + 1, y + 1, m_stride);
+}
+
+/*!
+    Returns index of cell at \a point coordinates.
+    \sa point()
+*/
+int GameMap::index(const Point &point) const
+{
+    return Math::calcIndex(point.x() + 1, point.y() + 1, m_stride);
+}
+
+/*!
+    Returns coordinates of cell with index \a index.
+    \sa index()
+*/
+Point GameMap::point(int index) const
+{
+    return Point(index % m_stride - 1, index / m_stride - 1);
+}
+
+/*!
+    Returns the count of cell indices (including the frame); arrays indexed by cell
+    index must have this size.
+*/
+int GameMap::indexCount() const
+{
+    return static_cast<int>(m_walls.size());
+}
+
+/*!
+    Returns the difference between indices of vertically adjacent cells.
+*/
+int GameMap::rowStride() const
+{
+    return m_stride;
+}
+
+/*!
+    Returns row \a y of game map packed into rowWords() 64-bit words: bit (x % 64) of word
+    (x / 64) is set if cell at x, \a y coordinates is empty. Bits beyond map width are zero.
+*/
+const std::uint64_t *GameMap::freeRow(int y) const
+{
+    return &m_freeBits[y * m_rowWords];
+}
+
+/*!
+    Returns count of 64-bit words in every packed row (see freeRow()).
+*/
+int GameMap::rowWords() const
+{
+    return m_rowWords;
+}
+
+/*!
+    Labels connected components of empty cells (see ComponentIndex). Labelling is kept up to
+    date as game map is modified, until clearComponents() or resize() is called.
+    \sa components()
+*/
+void GameMap::buildComponents()
+{
+    m_components.build(*this);
+}
+
+/*!
+    Loads precomputed labelling of connected components from \a labels (see
+    ComponentIndex::assign()).
+    \return false if \a labels are inconsistent with game map.
+*/
+bool GameMap::assignComponents(const std::int32_t *labels)
+{
+    return m_components.assign(*this, labels);
+}
+
+/*!
+    Drops labelling of connected components.
+*/
+void GameMap::clearComponents()
+{
+    m_components.clear();
+}
+
+/*!
+    Returns labelling of connected components of empty cells or null if it wasn't built.
+    \sa buildComponents()
+*/
+const ComponentIndex *GameMap::components() const
+{
+    return m_components.isEmpty() ? 0 : &m_components;
+}
+
+/*!
+    Builds abstract graph for hierarchical search with clusters of \a clusterSize x
+    \a clusterSize cells and entrances placed according to \a mode (see ClusterGraph). Graph
+    is dropped by clearClusters(), resize() or any cell change.
+    \sa clusters(), HierarchicalEngine
+*/
+void GameMap::buildClusters(int clusterSize, ClusterGraph::EntranceMode mode)
+{
+    m_clusters.build(*this, clusterSize, mode);
+}
+
+/*!
+    Drops abstract graph for hierarchical search.
+*/
+void GameMap::clearClusters()
+{
+    m_clusters.clear();
+}
+
+/*!
+    Returns abstract graph for hierarchical search or null if it wasn't built.
+    \sa buildClusters()
+*/
+const ClusterGraph *GameMap::clusters() const
+{
+    return m_clusters.isEmpty() ? 0 : &m_clusters;
+}
+
+/*!
+    Builds distance tables of \a count landmarks chosen according to \a mode for A* heuristic
+    (see LandmarkIndex). Tables are dropped by clearLandmarks(), resize() or any cell change.
+    \sa landmarks(), AStarEngine
+*/
+void GameMap::buildLandmarks(int count, LandmarkIndex::SelectionMode mode)
+{
+    m_landmarks.build(*this, count, mode);
+}
+
+/*!
+    Loads precomputed distance tables of \a count \a landmarks from \a distances (see
+    LandmarkIndex::assign()).
+    \return false if tables don't match game map.
+*/
+bool GameMap::assignLandmarks(int count, const std::int32_t *landmarks,
+                              const std::uint16_t *distances)
+{
+    return m_landmarks.assign(*this, count, landmarks, distances);
+}
+
+/*!
+    Drops distance tables of landmarks.
+*/
+void GameMap::clearLandmarks()
+{
+    m_landmarks.clear();
+}
+
+/*!
+    Returns distance tables of landmarks or null if they weren't built.
+    \sa buildLandmarks()
+*/
+const LandmarkIndex *GameMap::landmarks() const
+{
+    return m_landmarks.isEmpty() ? 0 : &m_landmarks;
+}
+
+/*!
+    Returns count of bytes allocated for cells storage (including components labelling, but
+    not abstract graph and landmark tables, see ClusterGraph::memoryUsage() and
+    LandmarkIndex::memoryUsage()).
+*/
+std::size_t GameMap::memoryUsage() const
+{
+    return m_walls.capacity() * sizeof(char) + m_freeBits.capacity() * sizeof(std::uint64_t)
+            + m_components.memoryUsage();
 }
@@ -1,9 +1,14 @@
 #ifndef GAMEMAP_H
 #define GAMEMAP_H
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
+#include "util/point.h"
 #include "util/size.h"
-#include "core/node.h"
+#include "core/clustergraph.h"
+#include "core/componentindex.h"
+#include "core/landmarkindex.h"
 
 class GameMap
 {
@@ -11,20 +16,60 @@ public:
     GameMap();
     explicit GameMap(const Size &size);
     GameMap(int width, int height);
-    ~GameMap();
 
     void resize(const Size &size);
     Size size() const;
-    const Node * const at(int x, int y) const;
-    const Node * const at(const Point &point) const;
-    Node * const at(int x, int y);
-    Node * const at(const Point &point);
     int width() const;
     int height() const;
 
+    bool isWall(int x, int y) const;
+    bool isWall(const Point &point) const;
+    bool isWall(int index) const;
+    void setWall(int x, int y, bool isWall);
+    void setWall(const Point &point, bool isWall);
+    void setRow(int y, const std::uint64_t *freeBits);
+
+    bool placeBall(const Point &point);
+    bool removeBall(const Point &point);
+    bool moveBall(const Point &from, const Point &to);
+
+    int index(int x, int y) const;
+    int index(const Point &point) const;
+    Point point(int index) const;
+    int indexCount() const;
+    int rowStride() const;
+
+    const std::uint64_t *freeRow(int y) const;
+    int rowWords() const;
+
+    void buildComponents();
+    bool assignComponents(const std::int32_t *labels);
+    void clearComponents();
+    const ComponentIndex *components() const;
+
+    void buildClusters(int clusterSize,
+                       ClusterGraph::EntranceMode mode = ClusterGraph::SparseEntrances);
+    void clearClusters();
+    const ClusterGraph *clusters() const;
+
+    void buildLandmarks(int count,
+                        LandmarkIndex::SelectionMode mode = LandmarkIndex::FarthestLandmarks);
+    bool assignLandmarks(int count, const std::int32_t *landmarks,
+                         const std::uint16_t *distances);
+    void clearLandmarks();
+    const LandmarkIndex *landmarks() const;
+
+    std::size_t memoryUsage() const;
+
 private:
     Size m_size;
-    std::vector<Node*> m_map;
+    int m_stride;
+    std::vector<char> m_walls;
+    int m_rowWords;
+    std::vector<std::uint64_t> m_freeBits;
+    ComponentIndex m_components;
+    ClusterGraph m_clusters;
+    LandmarkIndex m_landmarks;
 };
 
 #endif // GAMEMAP_H
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include "core/hierarchicalengine.h"
+
+namespace {
+    const int NoParent = -1;
+} // anonymous namespace
+
+/*!
+    \class HierarchicalEngine
+    \brief Implements hierarchical path finding (HPA*) over abstract graph of game map.
+
+    Engine requires abstract graph (see ClusterGraph) built for game map by
+    GameMap::buildClusters(); it's built once and reused by all the queries. Query is solved
+    in three steps:
+      - start and finish are connected to nodes of their clusters by breadth-first searches
+        limited to these clusters (see connectQuery());
+      - A* runs over abstract graph (with Manhattan distance heuristic, which is consistent
+        there as every edge costs at least Manhattan distance between its cells), so the
+        search expands a few nodes per cluster instead of every cell;
+      - abstract path is refined: every in-cluster edge of it is replaced by the shortest path
+        inside its cluster, so only clusters the path goes through are searched again.
+
+    With ClusterGraph::SparseEntrances paths may be longer than the shortest ones (up to
+    several times for short paths, see ClusterGraph for measured ratios); with
+    ClusterGraph::AllEntrances they have exactly the shortest length.
+    Count of expanded nodes is count of expanded abstract nodes.
+
+    You can read about this algorithm at:\n
+    \htmlonly
+    <a href="https://webdocs.cs.ualberta.ca/~mmueller/ps/hpastar.pdf">
+    Near Optimal Hierarchical Path-Finding</a>
+    \endhtmlonly
+
+    \sa AStarEngine, PathFinder
+*/
+
+/*!
+    Constructs hierarchical engine for searching paths at game map \a gm; it keeps its own
+    scratch for abstract graph, \a context isn't used.
+*/
+HierarchicalEngine::HierarchicalEngine(const GameMap *gm, SearchContext *context)
+    : SearchEngine(gm, context)
+{
+}
+
+/*!
+    Returns true if game map \a gm has abstract graph, i.e. engine can search at it.
+*/
+bool HierarchicalEngine::accepts(const GameMap *gm)
+{
+    return gm->clusters() != 0;
+}
+
+bool HierarchicalEngine::findPath(const Point &start, const Point &finish,
+                                  std::vector<int> &cells)
+{
+    m_expandedCount = 0;
+    m_stats.clear();
+    const ClusterGraph &graph = *m_gameMap->clusters();
+    const int startIndex = m_gameMap->index(start);
+    const int finishIndex = m_gameMap->index(finish);
+
+    connectQuery(graph, startIndex, finishIndex);
+    if (!searchAbstract(graph, start, finish))
+        return false;
+    refinePath(graph, startIndex, finishIndex, cells);
+    return true;
+}
+
+/*!
+    Returns count of bytes allocated for abstract search scratch.
+*/
+std::size_t HierarchicalEngine::memoryUsage() const
+{
+    return m_abstract.memoryUsage()
+            + (m_scratch.distance.capacity() + m_scratch.queue.capacity()
+               + m_finishCosts.capacity() + m_nodes.capacity()) * sizeof(int)
+            + m_startEdges.capacity() * sizeof(ClusterGraph::Edge);
+}
+
+/* private */
+
+/*!
+    Finds edges from \a start cell to nodes of its cluster (and to \a finish cell if it's in
+    the same cluster) and costs of edges from nodes of finish cluster to \a finish cell.
+    Start node of abstract search is nodeCount() and finish one is nodeCount() + 1.
+
+    Start cell is a ball, so it's never a transition, while the first step of path can cross
+    the border of its cluster; so start is also connected (through that step) to nodes of
+    clusters of its empty neighbours.
+*/
+void HierarchicalEngine::connectQuery(const ClusterGraph &graph, int start, int finish)
+{
+    const int offsets[] = { 0, -1, 1, -m_gameMap->rowStride(), m_gameMap->rowStride() };
+    const int startCluster = graph.cluster(m_gameMap->point(start));
+    const int finishCluster = graph.cluster(m_gameMap->point(finish));
+    const int finishNode = graph.nodeCount() + 1;
+
+    m_startEdges.clear();
+    for (int k = 0; k < 5; ++k) {
+        const int source = start + offsets[k];
+        if (k > 0 && m_gameMap->isWall(source))
+            continue;
+        const int cluster = graph.cluster(m_gameMap->point(source));
+        if (k > 0 && cluster == startCluster)
+            continue;
+
+        const int step = k > 0 ? 1 : 0;
+        graph.searchCluster(*m_gameMap, cluster, source, m_scratch);
+        for (int node = graph.firstNode(cluster); node < graph.lastNode(cluster); ++node) {
+            const int distance = graph.distance(*m_gameMap, cluster, graph.nodeCell(node),
+                                                m_scratch);
+            const ClusterGraph::Edge edge = { node, distance + step };
+            if (distance >= 0 && edge.cost > 0)
+                m_startEdges.push_back(edge);
+        }
+        if (cluster == finishCluster) {
+            const int distance = graph.distance(*m_gameMap, cluster, finish, m_scratch);
+            const ClusterGraph::Edge edge = { finishNode, distance + step };
+            if (distance >= 0 && edge.cost > 0)
+                m_startEdges.push_back(edge);
+        }
+    }
+
+    const int first = graph.firstNode(finishCluster);
+    m_finishCosts.resize(graph.lastNode(finishCluster) - first);
+    graph.searchCluster(*m_gameMap, finishCluster, finish, m_scratch);
+    for (std::size_t i = 0; i < m_finishCosts.size(); ++i)
+        m_finishCosts[i] = graph.distance(*m_gameMap, finishCluster,
+                                          graph.nodeCell(first + static_cast<int>(i)), m_scratch);
+}
+
+/*!
+    Runs A* over abstract graph from \a start to \a finish (see connectQuery()).
+    \return true if path found.
+*/
+bool HierarchicalEngine::searchAbstract(const ClusterGraph &graph, const Point &start,
+                                        const Point &finish)
+{
+    const int startNode = graph.nodeCount();
+    const int finishNode = graph.nodeCount() + 1;
+    const int finishCluster = graph.cluster(finish);
+    const int first = graph.firstNode(finishCluster);
+    const int last = graph.lastNode(finishCluster);
+    IndexedHeap &openList = m_abstract.heap();
+
+    m_abstract.reset(graph.nodeCount() + 2);
+    openList.reserve(graph.nodeCount() + 2);
+    m_abstract.reach(startNode, 0, NoParent);
+    openList.push(startNode, start.manhattanLengthTo(finish));
+    SEARCH_STAT(++m_stats.pushedCount);
+
+    while (!openList.isEmpty()) {
+        const int x = openList.pop();
+        if (x == finishNode) {
+            openList.clear();
+            return true;
+        }
+
+        m_abstract.close(x);
+        ++m_expandedCount;
+        SEARCH_STAT(++m_stats.closedCount);
+
+        const int g = m_abstract.g(x);
+        if (x == startNode) {
+            for (const ClusterGraph::Edge &edge : m_startEdges) {
+                relax(edge.node, g + edge.cost, x, edge.node == finishNode
+                      ? finish : m_gameMap->point(graph.nodeCell(edge.node)), finish);
+            }
+        } else {
+            for (const ClusterGraph::Edge *edge = graph.edgesBegin(x); edge != graph.edgesEnd(x);
+                 ++edge)
+                relax(edge->node, g + edge->cost, x, m_gameMap->point(graph.nodeCell(edge->node)),
+                      finish);
+            if (x >= first && x < last && m_finishCosts[x - first] >= 0)
+                relax(finishNode, g + m_finishCosts[x - first], x, finish, finish);
+        }
+        SEARCH_STAT(m_stats.maxOpenSize = Math::max(m_stats.maxOpenSize, openList.size()));
+    }
+
+    // Path not found
+    return false;
+}
+
+/*!
+    Updates abstract \a node (at \a point) reached with cost \a g from \a parent node.
+*/
+void HierarchicalEngine::relax(int node, int g, int parent, const Point &point,
+                               const Point &finish)
+{
+    if (m_abstract.isClosed(node))
+        return;
+
+    if (!m_abstract.isReached(node)) {
+        m_abstract.reach(node, g, parent);
+        m_abstract.heap().push(node, g + point.manhattanLengthTo(finish));
+        SEARCH_STAT(++m_stats.pushedCount);
+    } else if (g < m_abstract.g(node)) {
+        m_abstract.reach(node, g, parent);
+        m_abstract.heap().decreaseKey(node, g + point.manhattanLengthTo(finish));
+        SEARCH_STAT(++m_stats.decreaseKeyCount);
+    }
+}
+
+/*!
+    Fills \a cells with path cells from \a start to \a finish: transitions of abstract path are
+    kept as is and in-cluster edges are replaced by the shortest paths inside their clusters.
+*/
+void HierarchicalEngine::refinePath(const ClusterGraph &graph, int start, int finish,
+                                    std::vector<int> &cells)
+{
+    const int startNode = graph.nodeCount();
+    const int finishNode = graph.nodeCount() + 1;
+
+    m_nodes.clear();
+    for (int cur = finishNode; cur != NoParent; cur = m_abstract.parent(cur))
+        m_nodes.push_back(cur);
+    std::reverse(m_nodes.begin(), m_nodes.end());
+
+    const int offsets[] = { -1, 1, -m_gameMap->rowStride(), m_gameMap->rowStride() };
+    cells.assign(1, start);
+    for (std::size_t i = 1; i < m_nodes.size(); ++i) {
+        int from = m_nodes[i - 1] == startNode ? start : graph.nodeCell(m_nodes[i - 1]);
+        const int to = m_nodes[i] == finishNode ? finish : graph.nodeCell(m_nodes[i]);
+        const int cluster = graph.cluster(m_gameMap->point(to));
+        if (from == start && cluster != graph.cluster(m_gameMap->point(start))) {
+            // The first step crosses the border of start cluster (see connectQuery())
+            for (int k = 0; k < 4; ++k) {
+                const int next = start + offsets[k];
+                if (!m_gameMap->isWall(next) && graph.cluster(m_gameMap->point(next)) == cluster)
+                    from = next;
+            }
+            cells.push_back(from);
+        }
+        if (cluster != graph.cluster(m_gameMap->point(from))) {
+            cells.push_back(to); // transition to adjacent cluster
+            continue;
+        }
+        graph.searchCluster(*m_gameMap, cluster, from, m_scratch);
+        graph.appendClusterPath(*m_gameMap, cluster, to, m_scratch, cells);
+    }
+}
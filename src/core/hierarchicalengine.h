@@ -0,0 +1,31 @@
+#ifndef HIERARCHICALENGINE_H
+#define HIERARCHICALENGINE_H
+
+#include <cstddef>
+#include "core/clustergraph.h"
+#include "core/searchengine.h"
+
+class HierarchicalEngine : public SearchEngine
+{
+public:
+    HierarchicalEngine(const GameMap *gm, SearchContext *context);
+
+    static bool accepts(const GameMap *gm);
+
+    bool findPath(const Point &start, const Point &finish, std::vector<int> &cells);
+    std::size_t memoryUsage() const;
+
+private:
+    SearchContext m_abstract;               //!< Scratch of search over abstract graph.
+    ClusterGraph::Scratch m_scratch;
+    std::vector<ClusterGraph::Edge> m_startEdges;
+    std::vector<int> m_finishCosts;         //!< By node of finish cluster; -1 if unreachable.
+    std::vector<int> m_nodes;               //!< Abstract path.
+
+    void connectQuery(const ClusterGraph &graph, int start, int finish);
+    bool searchAbstract(const ClusterGraph &graph, const Point &start, const Point &finish);
+    void relax(int node, int g, int parent, const Point &point, const Point &finish);
+    void refinePath(const ClusterGraph &graph, int start, int finish, std::vector<int> &cells);
+};
+
+#endif // HIERARCHICALENGINE_H
@@ -0,0 +1,200 @@
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <cstddef>
+#include <vector>
+
+/*!
+    \class IndexedHeap
+    \brief Binary min-heap of cell indices with "decrease key" operation.
+
+    Every cell index (see GameMap::index()) can be contained in heap at most once; heap
+    remembers position of each contained index, so key of any index can be decreased in
+    O(log n) time. Used as open list of A* algorithm.
+
+    \note Hot methods are defined in this header to let compiler inline them into search loop.
+    \sa BucketQueue, PathFinder
+*/
+
+class IndexedHeap
+{
+public:
+    IndexedHeap();
+
+    void reserve(int indexCount);
+    void clear();
+    bool isEmpty() const;
+    int size() const;
+    bool contains(int index) const;
+    void push(int index, int key);
+    void decreaseKey(int index, int key);
+    int minKey() const;
+    int pop();
+    std::size_t memoryUsage() const;
+
+private:
+    struct Entry
+    {
+        int key;
+        int index;
+    };
+
+    std::vector<Entry> m_heap;
+    std::vector<int> m_position; //!< Position in m_heap for each index or -1.
+
+    void siftUp(int pos);
+    void siftDown(int pos);
+    void place(int pos, const Entry &entry);
+};
+
+/*!
+    Constructs empty heap; call reserve() before pushing any index.
+*/
+inline IndexedHeap::IndexedHeap()
+{
+}
+
+/*!
+    Prepares heap for storing indices from range [0, \a indexCount) and makes heap empty.
+*/
+inline void IndexedHeap::reserve(int indexCount)
+{
+    if (static_cast<int>(m_position.size()) != indexCount) {
+        m_heap.clear();
+        m_position.assign(indexCount, -1);
+    } else {
+        clear();
+    }
+}
+
+/*!
+    Removes all the indices from heap; takes O(n) time, where n is count of contained indices.
+*/
+inline void IndexedHeap::clear()
+{
+    for (std::size_t i = 0; i < m_heap.size(); ++i)
+        m_position[m_heap[i].index] = -1;
+    m_heap.clear();
+}
+
+/*!
+    Returns true if heap contains no indices.
+*/
+inline bool IndexedHeap::isEmpty() const
+{
+    return m_heap.empty();
+}
+
+/*!
+    Returns count of indices in heap.
+*/
+inline int IndexedHeap::size() const
+{
+    return static_cast<int>(m_heap.size());
+}
+
+/*!
+    Returns true if \a index is contained in heap.
+*/
+inline bool IndexedHeap::contains(int index) const
+{
+    return m_position[index] >= 0;
+}
+
+/*!
+    Inserts \a index with key \a key into heap.
+    \note \a index must not be contained in heap.
+*/
+inline void IndexedHeap::push(int index, int key)
+{
+    Entry entry = { key, index };
+    m_heap.push_back(entry);
+    m_position[index] = static_cast<int>(m_heap.size()) - 1;
+    siftUp(m_position[index]);
+}
+
+/*!
+    Sets key of contained \a index to \a key, which must not be greater than current key.
+*/
+inline void IndexedHeap::decreaseKey(int index, int key)
+{
+    int pos = m_position[index];
+    m_heap[pos].key = key;
+    siftUp(pos);
+}
+
+/*!
+    Returns minimal key of contained indices.
+    \note Heap must not be empty.
+*/
+inline int IndexedHeap::minKey() const
+{
+    return m_heap.front().key;
+}
+
+/*!
+    Removes index with minimal key from heap and returns it.
+    \note Heap must not be empty.
+*/
+inline int IndexedHeap::pop()
+{
+    int index = m_heap.front().index;
+    m_position[index] = -1;
+
+    Entry last = m_heap.back();
+    m_heap.pop_back();
+    if (!m_heap.empty()) {
+        place(0, last);
+        siftDown(0);
+    }
+    return index;
+}
+
+/*!
+    Returns count of bytes allocated by heap.
+*/
+inline std::size_t IndexedHeap::memoryUsage() const
+{
+    return m_heap.capacity() * sizeof(Entry) + m_position.capacity() * sizeof(int);
+}
+
+/* private */
+
+inline void IndexedHeap::siftUp(int pos)
+{
+    Entry entry = m_heap[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (m_heap[parent].key <= entry.key)
+            break;
+        place(pos, m_heap[parent]);
+        pos = parent;
+    }
+    place(pos, entry);
+}
+
+inline void IndexedHeap::siftDown(int pos)
+{
+    const int count = static_cast<int>(m_heap.size());
+    Entry entry = m_heap[pos];
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= count)
+            break;
+        if (child + 1 < count && m_heap[child + 1].key < m_heap[child].key)
+            ++child;
+        if (entry.key <= m_heap[child].key)
+            break;
+        place(pos, m_heap[child]);
+        pos = child;
+    }
+    place(pos, entry);
+}
+
+inline void IndexedHeap::place(int pos, const Entry &entry)
+{
+    m_heap[pos] = entry;
+    m_position[entry.index] = pos;
+}
+
+#endif // INDEXEDHEAP_H
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cstdint>
+#include "core/jpsengine.h"
+#include "util/math.h"
+
+namespace {
+    const int NoParent = -1;
+    const int NoJumpPoint = -1;
+} // anonymous namespace
+
+/*!
+    \class JpsEngine
+    \brief Implements Jump Point Search (JPS) for 4-connected grid with uniform step cost.
+
+    JPS is A* which doesn't push every reached cell to open list. Instead, from every expanded
+    node it moves ("jumps") along straight line until the cell where path can turn only
+    optimally: finish cell or cell with forced neighbour (empty side cell, which was blocked
+    for the previous cell of the line). Only such jump points are pushed to open list, so on
+    large open maps the search expands a few nodes per obstacle instead of whole symmetric
+    region between start and finish.
+
+    Paths are canonical: vertical moves are jumped first, and every cell of vertical jump also
+    scans both horizontal directions, so horizontal segments are found from any row. Found
+    path has the same (shortest) length as one found by AStarEngine.
+
+    Cost of step between jump points is their Manhattan distance (they're on the same row or
+    column); path cells between jump points are restored in reconstructPath().
+
+    You can read about this algorithm at:\n
+    \htmlonly
+    <a href="http://users.cecs.anu.edu.au/~dharabor/data/papers/harabor-grastien-aaai11.pdf">
+    Online Graph Pruning for Pathfinding on Grid Maps</a>
+    \endhtmlonly
+
+    \sa AStarEngine
+*/
+
+/*!
+    Constructs JPS engine for searching paths at game map \a gm using scratch \a context.
+*/
+JpsEngine::JpsEngine(const GameMap *gm, SearchContext *context)
+    : SearchEngine(gm, context), m_stride(0), m_finish(0)
+{
+}
+
+bool JpsEngine::findPath(const Point &start, const Point &finish, std::vector<int> &cells)
+{
+    m_expandedCount = 0;
+    m_stats.clear();
+    m_stride = m_gameMap->rowStride();
+    m_finish = m_gameMap->index(finish);
+    m_context->reset(m_gameMap->indexCount());
+
+    SearchContext &ctx = *m_context;
+    BucketQueue &openList = ctx.buckets();
+    const int startIndex = m_gameMap->index(start);
+    const int all[] = { -1, 1, -m_stride, m_stride };
+
+    openList.reserve(m_gameMap->indexCount());
+    ctx.reach(startIndex, 0, NoParent);
+    openList.push(startIndex, heuristicCostEstimate(startIndex, m_finish));
+    SEARCH_STAT(++m_stats.pushedCount);
+
+    while (!openList.isEmpty()) {
+        const int x = openList.pop();
+        if (x == m_finish) {
+            openList.clear();
+            reconstructPath(m_finish, cells);
+            return true;
+        }
+
+        ctx.close(x);
+        ++m_expandedCount;
+        SEARCH_STAT(++m_stats.closedCount);
+
+        // Natural neighbours: go on in the same direction or turn aside (but never go back)
+        int directions[4];
+        int count = 0;
+        const int parent = ctx.parent(x);
+        if (parent == NoParent) {
+            std::copy(all, all + 4, directions);
+            count = 4;
+        } else if (parent / m_stride == x / m_stride) {
+            directions[count++] = x > parent ? 1 : -1;
+            directions[count++] = -m_stride;
+            directions[count++] = m_stride;
+        } else {
+            directions[count++] = x > parent ? m_stride : -m_stride;
+            directions[count++] = -1;
+            directions[count++] = 1;
+        }
+
+        for (int k = 0; k < count; ++k) {
+            const int y = jump(x + directions[k], directions[k]);
+            if (y == NoJumpPoint || ctx.isClosed(y))
+                continue;
+
+            const int tentativeG = ctx.g(x) + heuristicCostEstimate(x, y);
+            if (!ctx.isReached(y)) {
+                ctx.reach(y, tentativeG, x);
+                openList.push(y, tentativeG + heuristicCostEstimate(y, m_finish));
+                SEARCH_STAT(++m_stats.pushedCount);
+            } else if (tentativeG < ctx.g(y)) {
+                ctx.reach(y, tentativeG, x);
+                openList.decreaseKey(y, tentativeG + heuristicCostEstimate(y, m_finish));
+                SEARCH_STAT(++m_stats.decreaseKeyCount);
+            }
+        }
+        SEARCH_STAT(m_stats.maxOpenSize = Math::max(m_stats.maxOpenSize, openList.size()));
+    }
+
+    // Path not found
+    return false;
+}
+
+/* private */
+
+/*!
+    Returns jump point found by moving from cell \a index (inclusive) with index step
+    \a direction, or NoJumpPoint if line is blocked before any jump point.
+*/
+int JpsEngine::jump(int index, int direction) const
+{
+    return direction == 1 || direction == -1 ? jumpHorizontal(index, direction)
+                                             : jumpVertical(index, direction);
+}
+
+/*!
+    Jumps horizontally; see jump(). Line is scanned by 64 cells at once over packed map rows
+    (see GameMap::freeRow()): stop mask of a word contains walls and forced neighbours.
+*/
+int JpsEngine::jumpHorizontal(int index, int direction) const
+{
+    const GameMap &gm = *m_gameMap;
+    const int x = index % m_stride - 1;
+    const int y = index / m_stride - 1;
+    if (x < 0 || x >= gm.width())
+        return NoJumpPoint;
+
+    const int words = gm.rowWords();
+    const std::uint64_t *row = gm.freeRow(y);
+    const std::uint64_t *up = y > 0 ? gm.freeRow(y - 1) : 0;
+    const std::uint64_t *down = y + 1 < gm.height() ? gm.freeRow(y + 1) : 0;
+    const int finishX = m_finish / m_stride == index / m_stride ? m_finish % m_stride - 1 : -1;
+
+    for (int w = x / 64; w >= 0 && w < words; w += direction) {
+        const std::uint64_t u = up ? up[w] : 0;
+        const std::uint64_t d = down ? down[w] : 0;
+
+        // Side cell is forced neighbour if it's empty but previous side cell is wall
+        std::uint64_t forced;
+        std::uint64_t mask;
+        if (direction > 0) {
+            const std::uint64_t uPrev = up && w > 0 ? up[w - 1] >> 63 : 0;
+            const std::uint64_t dPrev = down && w > 0 ? down[w - 1] >> 63 : 0;
+            forced = (u & ~((u << 1) | uPrev)) | (d & ~((d << 1) | dPrev));
+            mask = w == x / 64 ? ~std::uint64_t(0) << (x % 64) : ~std::uint64_t(0);
+        } else {
+            const std::uint64_t uNext = up && w + 1 < words ? up[w + 1] << 63 : 0;
+            const std::uint64_t dNext = down && w + 1 < words ? down[w + 1] << 63 : 0;
+            forced = (u & ~((u >> 1) | uNext)) | (d & ~((d >> 1) | dNext));
+            mask = w == x / 64 ? ~std::uint64_t(0) >> (63 - x % 64) : ~std::uint64_t(0);
+        }
+
+        std::uint64_t stop = ~row[w] | forced;
+        if (finishX >= 0 && finishX / 64 == w)
+            stop |= std::uint64_t(1) << (finishX % 64);
+        stop &= mask;
+        if (!stop)
+            continue;
+
+        const int bit = direction > 0 ? __builtin_ctzll(stop) : 63 - __builtin_clzll(stop);
+        if (!(row[w] >> bit & 1))
+            return NoJumpPoint; // wall comes before any jump point
+        return gm.index(w * 64 + bit, y);
+    }
+    return NoJumpPoint;
+}
+
+/*!
+    Jumps vertically; see jump(). Every cell of vertical line which has horizontal jump point
+    in any direction is jump point too.
+*/
+int JpsEngine::jumpVertical(int index, int direction) const
+{
+    const GameMap &gm = *m_gameMap;
+    for (;; index += direction) {
+        if (gm.isWall(index))
+            return NoJumpPoint;
+        if (index == m_finish)
+            return index;
+
+        const int back = index - direction;
+        if ((!gm.isWall(index - 1) && gm.isWall(back - 1))
+                || (!gm.isWall(index + 1) && gm.isWall(back + 1)))
+            return index;
+        if (jumpHorizontal(index - 1, -1) != NoJumpPoint
+                || jumpHorizontal(index + 1, 1) != NoJumpPoint)
+            return index;
+    }
+}
+
+/*!
+    Fills \a cells with path cells: jump points (by parents, started with cell \a finishIndex)
+    and all the cells of straight segments between them.
+*/
+void JpsEngine::reconstructPath(int finishIndex, std::vector<int> &cells) const
+{
+    cells.clear();
+    cells.push_back(finishIndex);
+    for (int cur = finishIndex; m_context->parent(cur) != NoParent; ) {
+        const int parent = m_context->parent(cur);
+        const int step = parent / m_stride == cur / m_stride ? 1 : m_stride;
+        const int direction = parent < cur ? -step : step;
+        for (int i = cur + direction; i != parent; i += direction)
+            cells.push_back(i);
+        cells.push_back(parent);
+        cur = parent;
+    }
+    std::reverse(cells.begin(), cells.end());
+}
+
+/*!
+    Returns Manhattan distance between cells with indices \a index1 and \a index2.
+*/
+int JpsEngine::heuristicCostEstimate(int index1, int index2) const
+{
+    return Math::abs(index1 % m_stride - index2 % m_stride)
+            + Math::abs(index1 / m_stride - index2 / m_stride);
+}
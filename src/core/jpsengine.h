@@ -0,0 +1,24 @@
+#ifndef JPSENGINE_H
+#define JPSENGINE_H
+
+#include "core/searchengine.h"
+
+class JpsEngine : public SearchEngine
+{
+public:
+    JpsEngine(const GameMap *gm, SearchContext *context);
+
+    bool findPath(const Point &start, const Point &finish, std::vector<int> &cells);
+
+private:
+    int m_stride;
+    int m_finish;
+
+    int jump(int index, int direction) const;
+    int jumpHorizontal(int index, int direction) const;
+    int jumpVertical(int index, int direction) const;
+    void reconstructPath(int finishIndex, std::vector<int> &cells) const;
+    int heuristicCostEstimate(int index1, int index2) const;
+};
+
+#endif // JPSENGINE_H
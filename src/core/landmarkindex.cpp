@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <random>
+#include "core/componentindex.h"
+#include "core/gamemap.h"
+#include "core/landmarkindex.h"
+
+namespace {
+    const unsigned RandomSeed = 1; //!< Makes random selection reproducible.
+} // anonymous namespace
+
+/*!
+    \class LandmarkIndex
+    \brief Distance tables from landmark cells for ALT (A*, landmarks, triangle inequality)
+    heuristic.
+
+    A few empty cells of game map are chosen as landmarks, and distance from every landmark
+    to every empty cell is computed by breadth-first search at build time. For any cells a and
+    b and landmark L the triangle inequality gives |d(L, a) - d(L, b)| <= d(a, b), so the
+    largest such difference over landmarks (see lowerBound()) is admissible and consistent
+    heuristic. On maps with walls and corridors it's much closer to the real distance than
+    Manhattan distance, so A* expands far fewer nodes (see AStarEngine).
+
+    Selection modes:
+      - FarthestLandmarks -- the first landmark is the cell farthest from the center of the
+        largest component (of empty cells, see ComponentIndex), every next one is the cell
+        farthest from all the chosen landmarks; landmarks lie at the "ends" of map, where
+        bounds are the tightest. Only the largest component gets landmarks (other ones are
+        searched with Manhattan distance), so it suits connected maps best;
+      - RandomLandmarks -- uniformly random empty cells (from fixed seed, so tables are
+        reproducible); weaker bounds, but cells of all the large components get some.
+
+    Distances are stored as 16-bit numbers, all the landmarks of a cell together, so bound of
+    a cell reads one short run of memory; distances longer than 65534 steps are saturated,
+    which keeps bound admissible and consistent (saturation doesn't increase differences).
+    Tables take 2 * landmarkCount() bytes per cell.
+
+    Tables are built once per game map and are read-only afterwards, so they're shared by all
+    the searches.
+
+    \sa GameMap::buildLandmarks(), AStarEngine
+*/
+
+/*!
+    Constructs empty index; call build() to compute tables of game map.
+*/
+LandmarkIndex::LandmarkIndex()
+    : m_count(0)
+{
+}
+
+/*!
+    Chooses \a count landmarks (1..MaxLandmarks) of game map \a gm according to \a mode and
+    computes distance tables from them. Fewer landmarks are chosen if map has not enough
+    distinct empty cells for them.
+*/
+void LandmarkIndex::build(const GameMap &gm, int count, SelectionMode mode)
+{
+    clear();
+    m_count = Math::min(Math::max(count, 1), int(MaxLandmarks));
+    m_distances.assign(std::size_t(gm.indexCount()) * m_count, Unreached);
+
+    std::vector<int> blank(gm.indexCount()); // distances before search: walls are -2
+    for (int index = 0; index < gm.indexCount(); ++index)
+        blank[index] = gm.isWall(index) ? -2 : -1;
+    std::vector<int> distance;
+    std::vector<int> queue;
+    if (mode == RandomLandmarks) {
+        int freeCount = 0;
+        for (int y = 0; y < gm.height(); ++y)
+            for (int x = 0; x < gm.width(); ++x)
+                freeCount += !gm.isWall(x, y);
+
+        // Distinct ranks of empty cells in row order
+        std::mt19937 rng(RandomSeed);
+        std::uniform_int_distribution<int> rank(0, Math::max(freeCount - 1, 0));
+        std::vector<int> ranks;
+        while (static_cast<int>(ranks.size()) < Math::min(m_count, freeCount)) {
+            const int r = rank(rng);
+            if (std::find(ranks.begin(), ranks.end(), r) == ranks.end())
+                ranks.push_back(r);
+        }
+        std::sort(ranks.begin(), ranks.end());
+
+        std::size_t next = 0;
+        for (int index = 0, r = 0; index < gm.indexCount() && next < ranks.size(); ++index) {
+            if (!gm.isWall(index) && r++ == ranks[next]) {
+                search(gm.rowStride(), index, blank, distance, queue);
+                storeLandmark(distance);
+                ++next;
+            }
+        }
+    } else {
+        // Seed is the cell of the largest component nearest to the center of map
+        ComponentIndex ownComponents;
+        const ComponentIndex *components = gm.components();
+        if (!components) {
+            ownComponents.build(gm);
+            components = &ownComponents;
+        }
+        int largest = -1;
+        for (int c = 0; c < components->componentLimit(); ++c) {
+            if (components->componentSize(c) > 0 && (largest < 0
+                    || components->componentSize(c) > components->componentSize(largest)))
+                largest = c;
+        }
+        const Point center(gm.width() / 2, gm.height() / 2);
+        int seed = -1;
+        int seedDistance = 0;
+        for (int y = 0; y < gm.height(); ++y) {
+            for (int x = 0; x < gm.width(); ++x) {
+                const int d = Point(x, y).manhattanLengthTo(center);
+                if (largest >= 0 && components->component(gm.index(x, y)) == largest
+                        && (seed < 0 || d < seedDistance)) {
+                    seed = gm.index(x, y);
+                    seedDistance = d;
+                }
+            }
+        }
+
+        std::vector<int> nearest; // distance to the nearest landmark, negative if unreached
+        int cell = seed >= 0 ? search(gm.rowStride(), seed, blank, distance, queue) : -1;
+        while (cell >= 0 && static_cast<int>(m_landmarks.size()) < m_count) {
+            search(gm.rowStride(), cell, blank, distance, queue);
+            storeLandmark(distance);
+            if (nearest.empty())
+                nearest = distance;
+            cell = -1;
+            for (std::size_t index = 0; index < nearest.size(); ++index) {
+                nearest[index] = Math::min(nearest[index], distance[index]);
+                if (nearest[index] > 0 && (cell < 0 || nearest[index] > nearest[cell]))
+                    cell = static_cast<int>(index);
+            }
+        }
+    }
+
+    // Drop columns of landmarks that weren't chosen
+    const int chosen = static_cast<int>(m_landmarks.size());
+    if (!chosen) {
+        clear();
+        return;
+    }
+    if (chosen < m_count) {
+        for (int index = 1; index < gm.indexCount(); ++index) {
+            std::copy(m_distances.begin() + std::size_t(index) * m_count,
+                      m_distances.begin() + std::size_t(index) * m_count + chosen,
+                      m_distances.begin() + std::size_t(index) * chosen);
+        }
+        m_distances.resize(std::size_t(gm.indexCount()) * chosen);
+        std::vector<std::uint16_t>(m_distances).swap(m_distances);
+        m_count = chosen;
+    }
+}
+
+/*!
+    Loads precomputed tables of game map \a gm: \a count cell numbers of \a landmarks (y *
+    width + x) and \a distances from all the landmarks for every cell row by row (as stored in
+    binary map file, see BinaryMap::LandmarksSection).
+    \return false (and leaves index empty) if landmarks aren't empty cells of map or their
+    tables are inconsistent.
+*/
+bool LandmarkIndex::assign(const GameMap &gm, int count, const std::int32_t *landmarks,
+                           const std::uint16_t *distances)
+{
+    clear();
+    if (count < 1 || count > MaxLandmarks)
+        return false;
+
+    const std::int64_t cellCount = std::int64_t(gm.width()) * gm.height();
+    for (int i = 0; i < count; ++i) {
+        if (landmarks[i] < 0 || landmarks[i] >= cellCount
+                || gm.isWall(landmarks[i] % gm.width(), landmarks[i] / gm.width())
+                || distances[std::size_t(landmarks[i]) * count + i] != 0)
+            return false;
+    }
+
+    m_count = count;
+    m_distances.assign(std::size_t(gm.indexCount()) * m_count, Unreached);
+    for (int i = 0; i < count; ++i)
+        m_landmarks.push_back(gm.index(landmarks[i] % gm.width(), landmarks[i] / gm.width()));
+    for (int y = 0; y < gm.height(); ++y) {
+        std::copy(distances + std::size_t(y) * gm.width() * m_count,
+                  distances + std::size_t(y + 1) * gm.width() * m_count,
+                  m_distances.begin() + std::size_t(gm.index(0, y)) * m_count);
+    }
+    return true;
+}
+
+/*!
+    Drops distance tables.
+*/
+void LandmarkIndex::clear()
+{
+    m_count = 0;
+    m_landmarks.clear();
+    std::vector<std::uint16_t>().swap(m_distances);
+}
+
+/*!
+    Returns true if tables weren't built.
+*/
+bool LandmarkIndex::isEmpty() const
+{
+    return m_landmarks.empty();
+}
+
+/*!
+    Returns count of landmarks.
+*/
+int LandmarkIndex::landmarkCount() const
+{
+    return m_count;
+}
+
+/*!
+    Returns index of cell (see GameMap::index()) of \a i-th landmark.
+*/
+int LandmarkIndex::landmark(int i) const
+{
+    return m_landmarks[i];
+}
+
+/*!
+    Returns count of bytes allocated for distance tables.
+*/
+std::size_t LandmarkIndex::memoryUsage() const
+{
+    return m_distances.capacity() * sizeof(std::uint16_t)
+            + m_landmarks.capacity() * sizeof(int);
+}
+
+/* private */
+
+/*!
+    Runs breadth-first search over empty cells from \a source cell: fills \a distance by cell
+    index, starting from \a blank (-2 for walls, -1 for empty cells), so that unreached cells
+    remain negative, and \a queue with reached cells in order of distance; \a stride is
+    GameMap::rowStride().
+    \return the farthest reached cell.
+*/
+int LandmarkIndex::search(int stride, int source, const std::vector<int> &blank,
+                          std::vector<int> &distance, std::vector<int> &queue) const
+{
+    const int offsets[4] = { -1, 1, -stride, stride };
+
+    distance = blank;
+    distance[source] = 0;
+    queue.assign(1, source);
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const int cur = queue[head];
+        for (int k = 0; k < 4; ++k) {
+            const int next = cur + offsets[k];
+            if (distance[next] == -1) {
+                distance[next] = distance[cur] + 1;
+                queue.push_back(next);
+            }
+        }
+    }
+    return queue.back();
+}
+
+/*!
+    Adds source of last search() (with \a distance filled by it) as landmark: its distances
+    become the next column of tables. Cells are written in index order, so the tables are
+    filled sequentially.
+*/
+void LandmarkIndex::storeLandmark(const std::vector<int> &distance)
+{
+    const std::size_t column = m_landmarks.size();
+    for (std::size_t index = 0; index < distance.size(); ++index) {
+        if (distance[index] == 0)
+            m_landmarks.push_back(static_cast<int>(index));
+        if (distance[index] >= 0)
+            m_distances[index * m_count + column] = static_cast<std::uint16_t>(
+                        Math::min(distance[index], int(MaxDistance)));
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef LANDMARKINDEX_H
+#define LANDMARKINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "util/math.h"
+
+class GameMap;
+
+class LandmarkIndex
+{
+public:
+    enum SelectionMode { FarthestLandmarks, RandomLandmarks };
+    enum { MaxLandmarks = 64 };
+
+    LandmarkIndex();
+
+    void build(const GameMap &gm, int count, SelectionMode mode);
+    bool assign(const GameMap &gm, int count, const std::int32_t *landmarks,
+                const std::uint16_t *distances);
+    void clear();
+    bool isEmpty() const;
+
+    int landmarkCount() const;
+    int landmark(int i) const;
+    std::uint16_t distance(int i, int index) const;
+    int lowerBound(int index, int target) const;
+
+    std::size_t memoryUsage() const;
+
+private:
+    enum {
+        MaxDistance = 0xFFFE, //!< Longer distances are stored saturated.
+        Unreached = 0xFFFF
+    };
+
+    int m_count;
+    std::vector<int> m_landmarks;           //!< Cell index of every landmark.
+    std::vector<std::uint16_t> m_distances; //!< Distances from all landmarks cell by cell.
+
+    int search(int stride, int source, const std::vector<int> &blank, std::vector<int> &distance,
+               std::vector<int> &queue) const;
+    void storeLandmark(const std::vector<int> &distance);
+};
+
+/*!
+    Returns distance in steps from \a i-th landmark to cell with index \a index (saturated at
+    65534) or 65535 if cell is wall or can't be reached from landmark.
+*/
+inline std::uint16_t LandmarkIndex::distance(int i, int index) const
+{
+    return m_distances[std::size_t(index) * m_count + i];
+}
+
+/*!
+    Returns lower bound of length of path between empty cells with indices \a index and
+    \a target by triangle inequality: distances from landmark to both cells differ by at most
+    the distance between cells. The largest bound over landmarks reaching both cells is taken.
+*/
+inline int LandmarkIndex::lowerBound(int index, int target) const
+{
+    const std::uint16_t *from = &m_distances[std::size_t(index) * m_count];
+    const std::uint16_t *to = &m_distances[std::size_t(target) * m_count];
+    int bound = 0;
+    for (int i = 0; i < m_count; ++i) {
+        if (from[i] != Unreached && to[i] != Unreached)
+            bound = Math::max(bound, Math::abs(int(from[i]) - int(to[i])));
+    }
+    return bound;
+}
+
+#endif // LANDMARKINDEX_H
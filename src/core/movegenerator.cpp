@@ -0,0 +1,112 @@
+#include "core/movegenerator.h"
+
+/*!
+    \class MoveGenerator
+    \brief Generates all the legal moves (ball, target cell) of game map in one pass.
+
+    Ball can be moved to any empty cell reachable from it, i.e. to any cell of components
+    (see ComponentIndex) adjacent to the ball. So instead of searching path for every pair of
+    ball and empty cell, generator labels components once and describes moves of every ball
+    by at most four component ids. Whole generation takes O(cells) time.
+
+    If game map keeps its own components labelling (see GameMap::buildComponents()), it's
+    used as is and no flood fill is run at all; otherwise generator labels map itself.
+
+    Path of the chosen move is found on demand by PathFinder.
+
+    \sa ComponentIndex, PathFinder
+*/
+
+/*!
+    Constructs generator of moves at game map \a gm; call generate() before using moves.
+*/
+MoveGenerator::MoveGenerator(const GameMap *gm)
+    : m_gameMap(gm), m_components(&m_ownComponents)
+{
+}
+
+/*!
+    Generates moves of all the balls for current state of game map. Must be called again
+    after game map is modified.
+*/
+void MoveGenerator::generate()
+{
+    const GameMap &gm = *m_gameMap;
+    const int offsets[4] = { -1, 1, -gm.rowStride(), gm.rowStride() };
+
+    m_components = gm.components();
+    if (!m_components) {
+        m_ownComponents.build(gm);
+        m_components = &m_ownComponents;
+    }
+    m_moves.clear();
+
+    for (int y = 0; y < gm.height(); ++y) {
+        for (int x = 0; x < gm.width(); ++x) {
+            const int index = gm.index(x, y);
+            if (!gm.isWall(index))
+                continue;
+
+            BallMoves moves;
+            moves.ball = Point(x, y);
+            moves.regionCount = 0;
+            moves.targetCount = 0;
+            for (int i = 0; i < 4; ++i) {
+                const int region = m_components->component(index + offsets[i]);
+                if (region < 0)
+                    continue;
+                bool isNew = true;
+                for (int j = 0; j < moves.regionCount; ++j)
+                    isNew = isNew && moves.regions[j] != region;
+                if (isNew) {
+                    moves.regions[moves.regionCount++] = region;
+                    moves.targetCount += m_components->componentSize(region);
+                }
+            }
+            m_moves.push_back(moves);
+        }
+    }
+}
+
+/*!
+    Returns moves of all the balls in row-major order of balls; ball which can't be moved
+    has no regions.
+*/
+const std::vector<BallMoves> &MoveGenerator::moves() const
+{
+    return m_moves;
+}
+
+/*!
+    Returns components of empty cells found by last generate() call.
+*/
+const ComponentIndex &MoveGenerator::components() const
+{
+    return *m_components;
+}
+
+/*!
+    Returns true if ball at \a ball point can be moved to \a target point.
+*/
+bool MoveGenerator::canMove(const Point &ball, const Point &target) const
+{
+    return m_gameMap->isWall(ball)
+            && m_components->isReachable(m_gameMap->index(ball), m_gameMap->index(target));
+}
+
+/*!
+    Replaces content of \a points by all the target cells of \a moves.
+*/
+void MoveGenerator::targets(const BallMoves &moves, std::vector<Point> &points) const
+{
+    points.clear();
+    for (int y = 0; y < m_gameMap->height(); ++y) {
+        for (int x = 0; x < m_gameMap->width(); ++x) {
+            const int component = m_components->component(m_gameMap->index(x, y));
+            for (int i = 0; i < moves.regionCount; ++i) {
+                if (moves.regions[i] == component)
+                    points.push_back(Point(x, y));
+            }
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef MOVEGENERATOR_H
+#define MOVEGENERATOR_H
+
+#include <vector>
+#include "util/point.h"
+#include "core/componentindex.h"
+#include "core/gamemap.h"
+
+/*!
+    \struct BallMoves
+    \brief Legal moves of one ball: components of empty cells the ball can be moved into.
+*/
+
+struct BallMoves
+{
+    Point ball;
+    int regionCount;  //!< Count of items in \a regions.
+    int regions[4];   //!< Distinct components adjacent to the ball.
+    int targetCount;  //!< Total count of cells of \a regions.
+};
+
+class MoveGenerator
+{
+public:
+    explicit MoveGenerator(const GameMap *gm);
+
+    void generate();
+
+    const std::vector<BallMoves> &moves() const;
+    const ComponentIndex &components() const;
+    bool canMove(const Point &ball, const Point &target) const;
+    void targets(const BallMoves &moves, std::vector<Point> &points) const;
+
+private:
+    const GameMap *m_gameMap;
+    ComponentIndex m_ownComponents;
+    const ComponentIndex *m_components;
+    std::vector<BallMoves> m_moves;
+
+    MoveGenerator(); // forbidden
+    MoveGenerator(const MoveGenerator &); // forbidden
+    MoveGenerator &operator=(const MoveGenerator &); // forbidden
+};
+
+#endif // MOVEGENERATOR_H
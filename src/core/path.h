@@ -1,13 +1,204 @@
 #ifndef PATH_H
 #define PATH_H
 
-#include <list>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
 #include "core/action.h"
 
 /*!
-    \typedef Path
-    Provides type for representing of path.
+    \class Path
+    \brief Provides type for representing of path.
+
+    Path is stored as start point plus one byte per step (direction of move, see
+    Action::Type) in contiguous array, so that even long paths take one allocation and can be
+    moved out cheaply. Iteration decodes steps to Action objects on the fly: every step
+    becomes action with its direction and point where it starts, and the last action is
+    Action::Finish at the finish point; so path of N steps has size() == N + 1 and empty path
+    (path not found) has size() == 0.
+
+    \note Methods are defined in this header to let compiler inline them into output loops.
+    \sa PathFinder, ResultWriter
+*/
+
+class Path
+{
+public:
+    class const_iterator
+    {
+    public:
+        Action operator*() const;
+        const_iterator &operator++();
+        bool operator==(const const_iterator &other) const;
+        bool operator!=(const const_iterator &other) const;
+
+    private:
+        const Path *m_path;
+        std::size_t m_index;
+        int m_x;
+        int m_y;
+
+        const_iterator(const Path *path, std::size_t index);
+
+        friend class Path;
+    };
+
+    Path();
+
+    void clear();
+    void reset(const Point &start, std::size_t length = 0);
+    void append(Action::Type move);
+    void swap(Path &other);
+
+    bool empty() const;
+    std::size_t size() const;
+    std::size_t length() const;
+    Action::Type move(std::size_t i) const;
+    Point start() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    Point m_start;
+    bool m_isEmpty;
+    std::vector<std::uint8_t> m_moves; //!< Action::Type of every step.
+};
+
+/*!
+    Constructs empty path.
+*/
+inline Path::Path()
+    : m_isEmpty(true)
+{
+}
+
+/*!
+    Makes path empty; keeps allocated memory for next reset().
+*/
+inline void Path::clear()
+{
+    m_isEmpty = true;
+    m_moves.clear();
+}
+
+/*!
+    Makes path that starts at \a start point and has no steps yet; memory for \a length steps
+    is reserved.
+    \sa append()
+*/
+inline void Path::reset(const Point &start, std::size_t length)
+{
+    m_start = start;
+    m_isEmpty = false;
+    m_moves.clear();
+    m_moves.reserve(length);
+}
+
+/*!
+    Appends one step with direction \a move (one of Action::Left, Right, Up or Down).
+*/
+inline void Path::append(Action::Type move)
+{
+    m_moves.push_back(static_cast<std::uint8_t>(move));
+}
+
+/*!
+    Swaps contents (and allocated memory) of this path with \a other path.
+*/
+inline void Path::swap(Path &other)
+{
+    std::swap(m_start, other.m_start);
+    std::swap(m_isEmpty, other.m_isEmpty);
+    m_moves.swap(other.m_moves);
+}
+
+/*!
+    Returns true if path is empty (e.g. path not found).
+*/
+inline bool Path::empty() const
+{
+    return m_isEmpty;
+}
+
+/*!
+    Returns count of actions in path, including the finish action.
+*/
+inline std::size_t Path::size() const
+{
+    return m_isEmpty ? 0 : m_moves.size() + 1;
+}
+
+/*!
+    Returns count of steps in path.
+*/
+inline std::size_t Path::length() const
+{
+    return m_moves.size();
+}
+
+/*!
+    Returns direction of step \a i without decoding points.
+*/
+inline Action::Type Path::move(std::size_t i) const
+{
+    return static_cast<Action::Type>(m_moves[i]);
+}
+
+/*!
+    Returns start point of path.
 */
-typedef std::list<Action> Path;
+inline Point Path::start() const
+{
+    return m_start;
+}
+
+inline Path::const_iterator Path::begin() const
+{
+    return const_iterator(this, 0);
+}
+
+inline Path::const_iterator Path::end() const
+{
+    return const_iterator(this, size());
+}
+
+inline Path::const_iterator::const_iterator(const Path *path, std::size_t index)
+    : m_path(path), m_index(index), m_x(path->m_start.x()), m_y(path->m_start.y())
+{
+}
+
+inline Action Path::const_iterator::operator*() const
+{
+    Action::Type type = m_index < m_path->m_moves.size() ? m_path->move(m_index)
+                                                         : Action::Finish;
+    return Action(type, Point(m_x, m_y));
+}
+
+inline Path::const_iterator &Path::const_iterator::operator++()
+{
+    if (m_index < m_path->m_moves.size()) {
+        switch (m_path->move(m_index)) {
+            case Action::Left:  --m_x; break;
+            case Action::Right: ++m_x; break;
+            case Action::Up:    --m_y; break;
+            case Action::Down:  ++m_y; break;
+            default: break;
+        }
+    }
+    ++m_index;
+    return *this;
+}
+
+inline bool Path::const_iterator::operator==(const const_iterator &other) const
+{
+    return m_index == other.m_index;
+}
+
+inline bool Path::const_iterator::operator!=(const const_iterator &other) const
+{
+    return m_index != other.m_index;
+}
 
 #endif // PATH_H
@@ -1,160 +1,228 @@
+#include <chrono>
 #include "core/pathfinder.h"
 
+#if defined(BALLPATH_STATS)
 namespace {
-    const int StepCost = 1;
+    typedef std::chrono::steady_clock Clock;
+
+    /*!
+        Returns duration \a d in milliseconds.
+    */
+    double toMsecs(Clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
 } // anonymous namespace
+#endif
 
 /*!
     \class PathFinder
-    \brief Implements A* (A-Star) algorithm for finding shortest path at game map.
+    \brief Finds shortest path at game map using one of search algorithms.
+
+    Available algorithms:
+      - Auto -- search on fixed 9x9 bitboard (see ColorLinesEngine) if map has ColorLines
+        board size, A* otherwise (default)
+      - AStar -- A* algorithm; see AStarEngine
+      - BidirectionalAStar -- A* searches from both start and finish meeting in the middle;
+        see AStarEngine::setBidirectional()
+      - BitBfs -- bit-parallel breadth-first search over packed map rows; see BitBfsEngine
+      - Jps -- Jump Point Search (A* with pruning of symmetric paths); see JpsEngine
+      - Hierarchical -- A* over abstract graph of clusters (HPA*) built by
+        GameMap::buildClusters(), for very large maps; see HierarchicalEngine. A* is used
+        if game map has no abstract graph.
+
+    All the algorithms find path of the same (shortest) length, but path itself may differ
+    if there are several shortest paths. The only exception is Hierarchical algorithm with
+    sparse entrances (see ClusterGraph::SparseEntrances), which may find longer paths.
+
+    If game map has components labelling (see GameMap::buildComponents()), unreachable
+    finish point is detected in O(1) time before any search.
+*/
 
-    In a nutshell, A* is most effective algorithm for finding of optimal path.
+/*!
+    Constructs PathFinder object for searching paths at game map \a gm.
+    \param gm Game map that contains information about cells type (wall or empty); map isn't
+    modified by searches, so it can be shared by many PathFinder objects.
+    \param context Scratch state for searches; if it's null, PathFinder uses its own context.
+    Context can be reused by consecutive PathFinder objects, but can't be shared by concurrent
+    searches.
+    \param openListType Priority queue implementation used for open list of A* algorithm.
+*/
+PathFinder::PathFinder(const GameMap *gm, SearchContext *context,
+                       AStarEngine::OpenListType openListType)
+    : m_gameMap(gm), m_context(context ? context : &m_ownContext),
+      m_astar(gm, m_context, openListType), m_bitBfs(gm, m_context),
+      m_colorLines(gm, m_context), m_jps(gm, m_context), m_hierarchical(gm, m_context),
+      m_algorithm(Auto), m_engine(&m_astar),
+      m_expandedCount(0), m_backwardExpandedCount(0)
+{
+}
 
-    You can read about this algorithm at:\n
-    \htmlonly
-    <a href="http://www.policyalmanac.org/games/aStarTutorial.htm">A* Tutorial</a><br>
-    <a href="http://en.wikipedia.org/wiki/A*_search_algorithm">A* at Wikipedia</a>
-    \endhtmlonly
+/*!
+    Selects search \a algorithm for next findPath() calls.
 */
+void PathFinder::setAlgorithm(Algorithm algorithm)
+{
+    m_algorithm = algorithm;
+    m_astar.setBidirectional(algorithm == BidirectionalAStar);
+    switch (algorithm) {
+    case BitBfs:
+        m_engine = &m_bitBfs;
+        break;
+    case Jps:
+        m_engine = &m_jps;
+        break;
+    case Hierarchical:
+        m_engine = &m_hierarchical;
+        break;
+    default:
+        m_engine = &m_astar;
+        break;
+    }
+}
 
 /*!
-    Constructs PathFinder object with all the input data.
-    \param gm Game map that contains array of nodes with information about it type (wall or empty).
-    \param start Start point, i.e. where moveable ball is placed.
-    \param finish Destination point (where ball need to be moved).
+    Returns selected search algorithm.
 */
-PathFinder::PathFinder(GameMap *gm, const Point &start, const Point &finish)
-    : m_gameMap(gm), m_start(start), m_finish(finish)
+PathFinder::Algorithm PathFinder::algorithm() const
 {
+    return m_algorithm;
 }
 
 /*!
-    Starts finding the path.
-    \return \a true if path found or \a false if there is no path for specified input data.
+    Starts finding the path from \a start point (where moveable ball is placed) to
+    \a finish point (where ball need to be moved). Can be called any number of times.
+    \return \a true if path found or \a false if there is no path for specified input data
+    (path() is empty then).
     \sa path()
 */
-bool PathFinder::findPath()
+bool PathFinder::findPath(const Point &start, const Point &finish)
 {
-    Node *startNode = m_gameMap->at(m_start);
-    Node *finishNode = m_gameMap->at(m_finish);
-    startNode->f = startNode->h = heuristicCostEstimate(m_start, m_finish);
-
-    m_openList.push(startNode);
-
-    while (!m_openList.empty()) {
-        Node *x = m_openList.top();
-        if (x == finishNode)
-            return reconstructPath();
-
-        m_openList.pop();
-        m_closedList.insert(x);
-
-        // Testing for each neighbour of x
-        for (Node::iterator it = x->begin(); it != x->end(); ++it) {
-            Node *y = *it;
-            if (!y || y->isWall || y == startNode || m_closedList.find(y) != m_closedList.end())
-                continue; // skip "zero" neighbours, walls, start point and closed-list neighbours
-
-            // Calculating g(x) for processing neighbour
-            int tentativeG = x->g + StepCost;
-            bool tentativeIsBetter;
-
-            if (!y->parent) { // if neighbour is not in open list yet
-                m_openList.push(y);
-                tentativeIsBetter = true;
-            } else if (tentativeG < y->g) {
-                tentativeIsBetter = true;
-            } else {
-                tentativeIsBetter = false;
-            }
-
-            // Updating fields of neighbour
-            if (tentativeIsBetter) {
-                // WARNING: potentially buggy place; need to manual rebuild heap
-                //          as values changed via pointer (y->f = ...)
-                y->parent = x;
-                y->g = tentativeG;
-                y->h = heuristicCostEstimate(y->point, m_finish);
-                y->f = y->g + y->h;
-                rebuildOpenList();
-            }
-        }
-    }
-
-    // Path not found
+    if (m_algorithm == Auto)
+        m_engine = ColorLinesEngine::accepts(m_gameMap) ? static_cast<SearchEngine *>(&m_colorLines)
+                                                        : &m_astar;
+    else if (m_algorithm == Hierarchical)
+        m_engine = HierarchicalEngine::accepts(m_gameMap)
+                ? static_cast<SearchEngine *>(&m_hierarchical) : &m_astar;
+
+    m_path.clear();
+    m_expandedCount = 0;
+    m_backwardExpandedCount = 0;
+    m_stats.clear();
+
+    const ComponentIndex *components = m_gameMap->components();
+    if (components && !components->isReachable(m_gameMap->index(start),
+                                                m_gameMap->index(finish)))
+        return false;
+
+#if defined(BALLPATH_STATS)
+    Clock::time_point t0 = Clock::now();
+    const bool found = m_engine->findPath(start, finish, m_cells);
+    m_stats = m_engine->stats();
+    m_stats.searchTime = toMsecs(Clock::now() - t0);
+#else
+    const bool found = m_engine->findPath(start, finish, m_cells);
+#endif
+    m_expandedCount = m_engine->expandedCount();
+    if (m_engine == &m_astar)
+        m_backwardExpandedCount = m_astar.backwardExpandedCount();
+    if (!found)
+        return false;
+
+#if defined(BALLPATH_STATS)
+    t0 = Clock::now();
+    makePath();
+    m_stats.reconstructTime = toMsecs(Clock::now() - t0);
+#else
+    makePath();
+#endif
     return true;
 }
 
 /*!
-    Returns finded path.
+    Returns finded path; it's valid until next findPath() call.
     \sa findPath()
 */
-Path PathFinder::path() const
+const Path &PathFinder::path() const
 {
     return m_path;
 }
 
-/* private */
+/*!
+    Moves finded path to \a path without copying its steps; path() becomes empty, and memory
+    of previous contents of \a path is reused by next findPath() call.
+    \sa path()
+*/
+void PathFinder::takePath(Path &path)
+{
+    m_path.swap(path);
+    m_path.clear();
+}
 
 /*!
-    Populates \a m_path variable (by parents, started with finish point).
-    \return true if path found.
+    Returns count of nodes expanded by last findPath() call.
 */
-bool PathFinder::reconstructPath()
+int PathFinder::expandedCount() const
 {
-    Node *startNode = m_gameMap->at(m_start);
-    Node *curNode = m_gameMap->at(m_finish);
-    Node *prevNode = nullptr;
-    do {
-        if (!curNode->parent && curNode != startNode)
-            return false; // there is no path
-        Action action(probeActionType(curNode, prevNode), curNode->point);
-        m_path.push_front(action);
-        prevNode = curNode;
-        curNode = curNode->parent;
-    } while (prevNode->parent != 0);
+    return m_expandedCount;
+}
 
-    return true;
+/*!
+    Returns count of nodes expanded by backward search of last findPath() call (they're
+    included into expandedCount()); it's 0 for all the algorithms except BidirectionalAStar.
+*/
+int PathFinder::backwardExpandedCount() const
+{
+    return m_backwardExpandedCount;
 }
 
 /*!
-    Returns estimated heuristical cost for path from \a p1 to \a p2.
+    Returns instrumentation counters and timing of last findPath() call; they're collected
+    only if project is built with BALLPATH_STATS (see SearchStats).
 */
-int PathFinder::heuristicCostEstimate(const Point &p1, const Point &p2) const
+const SearchStats &PathFinder::stats() const
 {
-    return p2.manhattanLengthTo(p1) * StepCost;
+    return m_stats;
 }
 
 /*!
-    Detects step direction from \a prev to \a cur.
+    Returns count of bytes allocated for search fields.
 */
-Action::Type PathFinder::probeActionType(const Node * const cur, const Node * const prev) const
+std::size_t PathFinder::memoryUsage() const
 {
-    Node *finishNode = m_gameMap->at(m_finish);
-    if (cur == finishNode)
-        return Action::Finish;
-    if (!cur || !prev)
-        return Action::Undefined;
+    return m_context->memoryUsage() + m_astar.memoryUsage() + m_bitBfs.memoryUsage()
+            + m_hierarchical.memoryUsage();
+}
 
-    if (cur->point.x() == prev->point.x() + 1)
-        return Action::Left;
-    if (cur->point.x() == prev->point.x() - 1)
-        return Action::Right;
-    if (cur->point.y() == prev->point.y() + 1)
-        return Action::Up;
-    if (cur->point.y() == prev->point.y() - 1)
-        return Action::Down;
+/* private */
 
-    return Action::Undefined;
+/*!
+    Populates \a m_path variable by path cells found by search engine.
+*/
+void PathFinder::makePath()
+{
+    const int count = static_cast<int>(m_cells.size());
+    if (!count)
+        return;
+
+    m_path.reset(m_gameMap->point(m_cells[0]), count - 1);
+    for (int i = 0; i + 1 < count; ++i)
+        m_path.append(probeActionType(m_cells[i], m_cells[i + 1]));
 }
 
 /*!
-    Initiates rebuilding of inner heap for open list.
+    Detects step direction from cell with index \a cur to cell with index \a next.
 */
-void PathFinder::rebuildOpenList()
+Action::Type PathFinder::probeActionType(int cur, int next) const
 {
-    Node *tmp = new Node;
-    tmp->f = -1;
-    m_openList.push(tmp);
-    m_openList.pop();
+    if (next == cur - 1)
+        return Action::Left;
+    if (next == cur + 1)
+        return Action::Right;
+    if (next == cur - m_gameMap->rowStride())
+        return Action::Up;
+    if (next == cur + m_gameMap->rowStride())
+        return Action::Down;
+
+    return Action::Undefined;
 }
@@ -1,37 +1,61 @@
 #ifndef PATHFINDER_H
 #define PATHFINDER_H
 
-#include <queue>
-#include <unordered_set>
+#include <cstddef>
+#include <vector>
 #include "util/point.h"
+#include "core/astarengine.h"
+#include "core/bitbfsengine.h"
+#include "core/fixedboardengine.h"
 #include "core/gamemap.h"
+#include "core/hierarchicalengine.h"
+#include "core/jpsengine.h"
 #include "core/path.h"
+#include "core/searchcontext.h"
+#include "core/searchstats.h"
 
 class PathFinder
 {
 public:
-    PathFinder(GameMap *gm, const Point &start, const Point &finish);
+    enum Algorithm { Auto, AStar, BidirectionalAStar, BitBfs, Jps, Hierarchical };
 
-    bool findPath();
-    Path path() const;
+    explicit PathFinder(const GameMap *gm, SearchContext *context = 0,
+                        AStarEngine::OpenListType openListType = AStarEngine::BucketOpenList);
 
-private:
-    GameMap *m_gameMap;
-    Point m_start;
-    Point m_finish;
+    void setAlgorithm(Algorithm algorithm);
+    Algorithm algorithm() const;
+
+    bool findPath(const Point &start, const Point &finish);
+    const Path &path() const;
+    void takePath(Path &path);
+    int expandedCount() const;
+    int backwardExpandedCount() const;
+    const SearchStats &stats() const;
+    std::size_t memoryUsage() const;
 
-    std::unordered_set<Node*> m_closedList;
-    std::priority_queue<Node*, std::vector<Node*>, NodePtrGreaterComparator> m_openList;
+private:
+    const GameMap *m_gameMap;
+    SearchContext m_ownContext;
+    SearchContext *m_context;
+    AStarEngine m_astar;
+    BitBfsEngine m_bitBfs;
+    ColorLinesEngine m_colorLines;
+    JpsEngine m_jps;
+    HierarchicalEngine m_hierarchical;
+    Algorithm m_algorithm;
+    SearchEngine *m_engine;
+    int m_expandedCount;
+    int m_backwardExpandedCount;
+    SearchStats m_stats;
+    std::vector<int> m_cells;
     Path m_path;
 
     PathFinder(); // forbidden
     PathFinder(const PathFinder &); // forbidden
     PathFinder &operator=(const PathFinder &); // forbidden
 
-    bool reconstructPath();
-    int heuristicCostEstimate(const Point &p1, const Point &p2) const;
-    Action::Type probeActionType(const Node * const cur, const Node * const prev) const;
-    void rebuildOpenList();
+    void makePath();
+    Action::Type probeActionType(int cur, int next) const;
 };
 
 #endif // PATHFINDER_H
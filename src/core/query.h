@@ -0,0 +1,22 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "util/point.h"
+
+/*!
+    \struct Query
+    \brief Represents one path query: start point (ball position) and finish point.
+*/
+
+struct Query
+{
+    Point start;
+    Point finish;
+
+    explicit Query(const Point &start = Point(), const Point &finish = Point())
+        : start(start), finish(finish)
+    {
+    }
+};
+
+#endif // QUERY_H
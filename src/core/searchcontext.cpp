@@ -0,0 +1,51 @@
+#include <limits>
+#include "core/searchcontext.h"
+
+/*!
+    \class SearchContext
+    \brief Keeps per-search scratch state (parents, weights, open and closed lists).
+
+    All the fields are stored in arrays indexed by cell index (see GameMap::index()), so
+    GameMap itself stays read-only and may be shared by any number of searches.
+
+    Every cell carries a generation stamp: cell is considered reached only if its stamp
+    belongs to current search. So reset() between searches takes O(1) time instead of
+    O(cells); arrays are cleared only when map size changes or stamp counter overflows.
+
+    One context can serve any number of consecutive searches, but only one at a time.
+
+    \sa PathFinder
+*/
+
+/*!
+    Constructs empty context; it's resized on first reset().
+*/
+SearchContext::SearchContext()
+    : m_epoch(0)
+{
+}
+
+/*!
+    Prepares context for new search on map with \a indexCount cell indices.
+*/
+void SearchContext::reset(int indexCount)
+{
+    m_epoch += 2;
+    if (static_cast<int>(m_stamp.size()) != indexCount
+            || m_epoch > std::numeric_limits<unsigned>::max() - 2) {
+        m_epoch = 2;
+        m_stamp.assign(indexCount, 0);
+        m_g.resize(indexCount);
+        m_parent.resize(indexCount);
+    }
+}
+
+/*!
+    Returns count of bytes allocated by context.
+*/
+std::size_t SearchContext::memoryUsage() const
+{
+    return m_stamp.capacity() * sizeof(unsigned)
+            + (m_g.capacity() + m_parent.capacity()) * sizeof(int)
+            + m_heap.memoryUsage() + m_buckets.memoryUsage();
+}
@@ -0,0 +1,103 @@
+#ifndef SEARCHCONTEXT_H
+#define SEARCHCONTEXT_H
+
+#include <cstddef>
+#include <vector>
+#include "core/bucketqueue.h"
+#include "core/indexedheap.h"
+
+class SearchContext
+{
+public:
+    SearchContext();
+
+    void reset(int indexCount);
+
+    bool isReached(int index) const;
+    bool isClosed(int index) const;
+    int g(int index) const;
+    int parent(int index) const;
+    void reach(int index, int g, int parent);
+    void close(int index);
+
+    IndexedHeap &heap();
+    BucketQueue &buckets();
+
+    std::size_t memoryUsage() const;
+
+private:
+    unsigned m_epoch;
+    std::vector<unsigned> m_stamp; //!< m_epoch if reached, m_epoch + 1 if closed.
+    std::vector<int> m_g;
+    std::vector<int> m_parent;
+    IndexedHeap m_heap;
+    BucketQueue m_buckets;
+};
+
+/*!
+    Returns true if cell with \a index was reached (opened or closed) during current search.
+*/
+inline bool SearchContext::isReached(int index) const
+{
+    return m_stamp[index] >= m_epoch;
+}
+
+/*!
+    Returns true if cell with \a index was closed (expanded) during current search.
+*/
+inline bool SearchContext::isClosed(int index) const
+{
+    return m_stamp[index] == m_epoch + 1;
+}
+
+/*!
+    Returns passed steps weight of reached cell with \a index.
+*/
+inline int SearchContext::g(int index) const
+{
+    return m_g[index];
+}
+
+/*!
+    Returns index of parent of reached cell with \a index or -1 if cell has no parent.
+*/
+inline int SearchContext::parent(int index) const
+{
+    return m_parent[index];
+}
+
+/*!
+    Marks cell with \a index as reached with weight \a g from cell with index \a parent.
+*/
+inline void SearchContext::reach(int index, int g, int parent)
+{
+    m_stamp[index] = m_epoch;
+    m_g[index] = g;
+    m_parent[index] = parent;
+}
+
+/*!
+    Marks reached cell with \a index as closed.
+*/
+inline void SearchContext::close(int index)
+{
+    m_stamp[index] = m_epoch + 1;
+}
+
+/*!
+    Returns binary heap open list.
+*/
+inline IndexedHeap &SearchContext::heap()
+{
+    return m_heap;
+}
+
+/*!
+    Returns bucket queue open list.
+*/
+inline BucketQueue &SearchContext::buckets()
+{
+    return m_buckets;
+}
+
+#endif // SEARCHCONTEXT_H
@@ -0,0 +1,49 @@
+#include "core/searchengine.h"
+
+/*!
+    \class SearchEngine
+    \brief Base class for shortest path search algorithms used by PathFinder.
+
+    Engine finds the shortest path at read-only game map and returns it as sequence of cell
+    indices (see GameMap::index()); converting it to the Path is up to PathFinder.
+    Scratch state which must survive between searches is kept in SearchContext or in engine
+    itself, so one engine must not be used by concurrent searches.
+
+    \sa AStarEngine, BitBfsEngine
+*/
+
+/*!
+    Constructs engine for searching paths at game map \a gm using scratch \a context.
+*/
+SearchEngine::SearchEngine(const GameMap *gm, SearchContext *context)
+    : m_gameMap(gm), m_context(context), m_expandedCount(0)
+{
+}
+
+SearchEngine::~SearchEngine()
+{
+}
+
+/*!
+    \fn bool SearchEngine::findPath(const Point &start, const Point &finish,
+                                    std::vector<int> &cells)
+    Finds the shortest path from \a start point (ball position) to \a finish point (empty cell).
+    If path is found, returns true and fills \a cells with indices of all the path cells, from
+    start to finish inclusive; otherwise returns false.
+*/
+
+/*!
+    Returns count of nodes expanded by last findPath() call.
+*/
+int SearchEngine::expandedCount() const
+{
+    return m_expandedCount;
+}
+
+/*!
+    Returns instrumentation counters of last findPath() call (see SearchStats).
+*/
+const SearchStats &SearchEngine::stats() const
+{
+    return m_stats;
+}
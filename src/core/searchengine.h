@@ -0,0 +1,31 @@
+#ifndef SEARCHENGINE_H
+#define SEARCHENGINE_H
+
+#include <vector>
+#include "util/point.h"
+#include "core/gamemap.h"
+#include "core/searchcontext.h"
+#include "core/searchstats.h"
+
+class SearchEngine
+{
+public:
+    SearchEngine(const GameMap *gm, SearchContext *context);
+    virtual ~SearchEngine();
+
+    virtual bool findPath(const Point &start, const Point &finish, std::vector<int> &cells) = 0;
+    int expandedCount() const;
+    const SearchStats &stats() const;
+
+protected:
+    const GameMap *m_gameMap;
+    SearchContext *m_context;
+    int m_expandedCount;
+    SearchStats m_stats;
+
+private:
+    SearchEngine(const SearchEngine &); // forbidden
+    SearchEngine &operator=(const SearchEngine &); // forbidden
+};
+
+#endif // SEARCHENGINE_H
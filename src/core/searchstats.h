@@ -0,0 +1,77 @@
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+
+#include "util/math.h"
+
+/*!
+    \def SEARCH_STAT(...)
+    Executes statement given as argument (updating of SearchStats counters) only if project
+    is built with BALLPATH_STATS defined (see BALLPATH_STATS option of CMake); otherwise
+    compiles to nothing, so that search loops aren't slowed down by instrumentation.
+*/
+#if defined(BALLPATH_STATS)
+#  define SEARCH_STAT(...) do { __VA_ARGS__; } while (0)
+#else
+#  define SEARCH_STAT(...) do { } while (0)
+#endif
+
+/*!
+    \struct SearchStats
+    \brief Instrumentation counters of one search (or sum of several searches, see add()).
+
+    Counters are collected only if BALLPATH_STATS is defined (see SEARCH_STAT()); otherwise
+    all of them stay zero. Open list counters are collected by engines that have open list
+    (AStarEngine and JpsEngine); other engines report count of expanded nodes only (see
+    SearchEngine::expandedCount()).
+*/
+struct SearchStats
+{
+    long long pushedCount;      //!< Nodes pushed to open list.
+    long long decreaseKeyCount; //!< Decrease-key operations of open list.
+    long long closedCount;      //!< Nodes moved to closed list.
+    int maxOpenSize;            //!< Maximal size of open list.
+    double searchTime;          //!< Milliseconds spent in search engine (set by PathFinder).
+    double reconstructTime;     //!< Milliseconds spent for building Path (set by PathFinder).
+
+    SearchStats() { clear(); }
+
+    /*!
+        Sets all the counters to zero.
+    */
+    void clear()
+    {
+        pushedCount = 0;
+        decreaseKeyCount = 0;
+        closedCount = 0;
+        maxOpenSize = 0;
+        searchTime = 0;
+        reconstructTime = 0;
+    }
+
+    /*!
+        Accumulates counters of \a other search: sums them up (maxOpenSize is maximized).
+    */
+    void add(const SearchStats &other)
+    {
+        pushedCount += other.pushedCount;
+        decreaseKeyCount += other.decreaseKeyCount;
+        closedCount += other.closedCount;
+        maxOpenSize = Math::max(maxOpenSize, other.maxOpenSize);
+        searchTime += other.searchTime;
+        reconstructTime += other.reconstructTime;
+    }
+
+    /*!
+        Returns true if counters are collected by this build.
+    */
+    static bool isEnabled()
+    {
+#if defined(BALLPATH_STATS)
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+#endif // SEARCHSTATS_H
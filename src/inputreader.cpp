@@ -1,9 +1,39 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "binarymap.h"
 #include "inputreader.h"
+#include "util/endian.h"
+#include "util/rowparser.h"
+
+namespace {
+    /*!
+        Returns \a count little-endian items of type \a T at \a data in host byte order: the
+        data itself on little-endian host, otherwise its converted copy in \a storage.
+    */
+    template <typename T>
+    const T *toHostArray(const char *data, std::size_t count, std::vector<T> &storage)
+    {
+        if (Endian::isLittleEndianHost())
+            return reinterpret_cast<const T *>(data);
+        storage.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+            storage[i] = Endian::load<T>(data + i * sizeof(T));
+        return storage.data();
+    }
+} // anonymous namespace
 
 /*!
     \class InputReader
     \brief Reads input file with objective data and provides convenient access for it.
 
+    File is memory-mapped (see MappedFile) and parsed right from mapped bytes: rows of game map
+    are packed into words by RowParser and stored by whole rows (see GameMap::setRow()), so
+    that reading of huge maps isn't limited by per-character stream calls.
+
     \b Input \b file \b format.
 
     Line 1: rows count (one integer number).\n
@@ -11,6 +41,9 @@
     Line 3: start point coordinates with format "(x,y)" (without quotes).\n
     Line 4: finish point coordinates with format "(x,y)" (without quotes).\n
     Line 5 (et seq.): initial game map, where 0 is empty cell and 1 is ball ("wall" field).\n
+    Lines after game map (optional): additional queries with format "(x,y)->(x,y)" (without
+    quotes), one per line: start point and finish point. They're read only in batch mode
+    (see queries()), so such file is also valid for single query mode.\n
 
     Input file example:
     \code
@@ -26,10 +59,41 @@
     0000
     1001
     \endcode
+
+    Batch input file example (three queries for the map above):
+    \code
+    7
+    4
+    (0,0)
+    (2,5)
+    1000
+    0101
+    0100
+    0010
+    0000
+    0000
+    1001
+    (0,0)->(3,3)
+    (3,0)->(1,1)
+    \endcode
+
+    \b Binary \b input \b file \b format.
+
+    The same data can be stored in binary file (see BinaryMap and ballpath-convert tool),
+    which is recognized by its signature and loaded without parsing (numbers are stored
+    little-endian on any host): header with format version, dimensions, start and finish
+    points is followed by section table; the walls section holds packed rows (as
+    GameMap::freeRow()), optional sections hold additional queries, precomputed labelling of
+    connected components (which is used instead of building it if components are enabled, see
+    setComponentsEnabled()) and precomputed landmark tables (which are used instead of
+    building them if landmarks are enabled, see setLandmarkCount()).
 */
 
 InputReader::InputReader()
-    : m_start(-1, -1), m_finish(-1, -1), m_gameMap(new GameMap)
+    : m_pos(0), m_end(0), m_start(-1, -1), m_finish(-1, -1), m_gameMap(new GameMap),
+      m_componentsEnabled(false), m_clusterSize(0), m_entranceMode(ClusterGraph::SparseEntrances),
+      m_landmarkCount(0), m_selectionMode(LandmarkIndex::FarthestLandmarks),
+      m_buildTime(0), m_clusterBuildTime(0), m_landmarkBuildTime(0)
 {
 }
 
@@ -38,32 +102,87 @@ InputReader::~InputReader()
     delete m_gameMap;
 }
 
+/*!
+    If \a enabled is true, connected components of game map are labelled right after map is
+    read (see GameMap::buildComponents()) or loaded from binary map file if it has them.
+*/
+void InputReader::setComponentsEnabled(bool enabled)
+{
+    m_componentsEnabled = enabled;
+}
+
+/*!
+    If \a clusterSize is positive, abstract graph for hierarchical search with clusters of
+    \a clusterSize x \a clusterSize cells and entrances placed according to \a mode is built
+    right after map is read (see GameMap::buildClusters()); by default it isn't built.
+*/
+void InputReader::setClusterSize(int clusterSize, ClusterGraph::EntranceMode mode)
+{
+    m_clusterSize = clusterSize;
+    m_entranceMode = mode;
+}
+
+/*!
+    If \a count is positive, distance tables of \a count landmarks chosen according to \a mode
+    are built right after map is read (see GameMap::buildLandmarks()) or loaded from binary
+    map file if it has them (with landmarks stored in file); by default they aren't built.
+*/
+void InputReader::setLandmarkCount(int count, LandmarkIndex::SelectionMode mode)
+{
+    m_landmarkCount = count;
+    m_selectionMode = mode;
+}
+
 /*!
     Reads all the input data from \a filePath file.
+    If \a withQueries is true, additional queries after game map are read as well.
     \return true if operation finished successfully.
-    \sa errorString()
+    \sa errorString(), queries()
 */
-bool InputReader::read(const std::string &filePath)
+bool InputReader::read(const std::string &filePath, bool withQueries)
 {
-    m_file.open(filePath, std::ios_base::in);
-
-    if (!m_file.good()) {
+    if (!m_file.open(filePath)) {
         m_errorString = "Open file error: probably file doesn't exist";
-        m_file.close();
         return false;
     }
+    m_pos = m_file.data();
+    m_end = m_pos + m_file.size();
 
-    if (!(readGameMapSize() && readStartPoint() && readFinishPoint() && readGameMapContent())) {
-        m_file.close();
-        return false;
-    }
+    const bool isBinary = BinaryMap::isBinary(m_pos, m_file.size());
+    bool isRead = isBinary ? readBinaryMap()
+                           : readGameMapSize() && readStartPoint() && readFinishPoint()
+                             && readGameMapContent();
+    if (isRead) {
+        if (m_componentsEnabled && !m_gameMap->components()) {
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            m_gameMap->buildComponents();
+            m_buildTime = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - t0).count();
+        }
+        if (m_clusterSize > 0) {
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            m_gameMap->buildClusters(m_clusterSize, m_entranceMode);
+            m_clusterBuildTime = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - t0).count();
+        }
+        if (m_landmarkCount > 0 && !m_gameMap->landmarks()) {
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            m_gameMap->buildLandmarks(m_landmarkCount, m_selectionMode);
+            m_landmarkBuildTime = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - t0).count();
+        }
 
-    // Transform to inner coordinate system (inverted Y-axis)
-    m_start.ry() = m_gameMap->size().height() - 1 - m_start.ry();
-    m_finish.ry() = m_gameMap->size().height() - 1 - m_finish.ry();
+        // Transform to inner coordinate system (inverted Y-axis)
+        m_start.ry() = m_gameMap->size().height() - 1 - m_start.ry();
+        m_finish.ry() = m_gameMap->size().height() - 1 - m_finish.ry();
+        m_queries.assign(1, Query(m_start, m_finish));
+
+        if (withQueries)
+            isRead = isBinary ? readBinaryQueries() : readQueries();
+    }
 
     m_file.close();
-    return true;
+    return isRead;
 }
 
 /*!
@@ -75,6 +194,35 @@ std::string InputReader::errorString() const
     return m_errorString;
 }
 
+/*!
+    Returns milliseconds spent by last read() call for building search structures of game map
+    (labelling of connected components); it's included into time of read() call.
+*/
+double InputReader::buildTime() const
+{
+    return m_buildTime;
+}
+
+/*!
+    Returns milliseconds spent by last read() call for building abstract graph for
+    hierarchical search (see setClusterSize()); it's included into time of read() call, but
+    not into buildTime().
+*/
+double InputReader::clusterBuildTime() const
+{
+    return m_clusterBuildTime;
+}
+
+/*!
+    Returns milliseconds spent by last read() call for building landmark tables (see
+    setLandmarkCount()); it's included into time of read() call, but not into buildTime().
+    It's zero if tables were loaded from binary map file.
+*/
+double InputReader::landmarkBuildTime() const
+{
+    return m_landmarkBuildTime;
+}
+
 /*!
     Returns readed start position point (moveable ball position).
     \sa finishPoint(), gameMap()
@@ -93,11 +241,21 @@ Point InputReader::finishPoint() const
     return m_finish;
 }
 
+/*!
+    Returns readed queries; the first one is always query from start point to finish point,
+    the rest are additional queries read in batch mode.
+    \sa read()
+*/
+const std::vector<Query> &InputReader::queries() const
+{
+    return m_queries;
+}
+
 /*!
     Returns readed game map (as two-dimensional array that represents game field with balls).
     \sa startPoint(), finishPoint()
 */
-GameMap *InputReader::gameMap() const
+const GameMap *InputReader::gameMap() const
 {
     return m_gameMap;
 }
@@ -106,26 +264,52 @@ GameMap *InputReader::gameMap() const
 
 void InputReader::skipNonNum()
 {
-    char c;
-    while (m_file.get(c)) {
-        if (isdigit(c)) {
-            m_file.putback(c);
-            break;
-        }
-    }
+    while (m_pos != m_end && (*m_pos < '0' || *m_pos > '9'))
+        ++m_pos;
 }
 
-bool InputReader::readGameMapSize()
+/*
+    Reads decimal number (with optional sign if skipSpaces is true, after skipping white
+    spaces) like operator>>() of stream does. Returns false if there is no number at current
+    position or it's out of int range; value isn't changed then.
+*/
+bool InputReader::readNumber(int &value, bool skipSpaces)
 {
-    if (m_file.eof()) {
-        m_errorString = "EOF reached when reading game map dimensions";
+    bool isNegative = false;
+    if (skipSpaces) {
+        while (m_pos != m_end && std::isspace(static_cast<unsigned char>(*m_pos)))
+            ++m_pos;
+        if (m_pos != m_end && (*m_pos == '-' || *m_pos == '+'))
+            isNegative = *m_pos++ == '-';
+    }
+    if (m_pos == m_end || *m_pos < '0' || *m_pos > '9')
+        return false;
+
+    long long number = 0;
+    bool isOverflow = false;
+    for (; m_pos != m_end && *m_pos >= '0' && *m_pos <= '9'; ++m_pos) {
+        number = number * 10 + (*m_pos - '0');
+        if (number > std::numeric_limits<int>::max() + 1LL) {
+            isOverflow = true;
+            number = 0;
+        }
+    }
+    if (isNegative)
+        number = -number;
+    if (isOverflow || number > std::numeric_limits<int>::max()
+            || number < std::numeric_limits<int>::min()) {
         return false;
     }
 
+    value = static_cast<int>(number);
+    return true;
+}
+
+bool InputReader::readGameMapSize()
+{
     Size size(-1, -1);
-    m_file >> size.rheight();
-    m_file >> size.rwidth();
-    if (size.width() <= 0 || size.height() <= 0) {
+    if (!(readNumber(size.rheight(), true) && readNumber(size.rwidth(), true))
+            || size.width() <= 0 || size.height() <= 0) {
         m_errorString = "Invalid map dimensions";
         return false;
     }
@@ -136,15 +320,15 @@ bool InputReader::readGameMapSize()
 
 bool InputReader::readStartPoint()
 {
-    if (m_file.eof()) {
+    if (m_pos == m_end) {
         m_errorString = "EOF reached when reading start point";
         return false;
     }
 
     skipNonNum();
-    m_file >> m_start.rx();
+    readNumber(m_start.rx());
     skipNonNum();
-    m_file >> m_start.ry();
+    readNumber(m_start.ry());
     if (!validatePointBounds(m_start)) {
         m_errorString = "Invalid start point specified";
         return false;
@@ -154,15 +338,15 @@ bool InputReader::readStartPoint()
 
 bool InputReader::readFinishPoint()
 {
-    if (m_file.eof()) {
+    if (m_pos == m_end) {
         m_errorString = "EOF reached when reading finish point";
         return false;
     }
 
     skipNonNum();
-    m_file >> m_finish.rx();
+    readNumber(m_finish.rx());
     skipNonNum();
-    m_file >> m_finish.ry();
+    readNumber(m_finish.ry());
     if (!validatePointBounds(m_finish)) {
         m_errorString = "Invalid finish point specified";
         return false;
@@ -170,35 +354,230 @@ bool InputReader::readFinishPoint()
     return true;
 }
 
+/*
+    Parses rows right from the mapped file into packed rows of game map (see
+    GameMap::setRow()) with vectorized RowParser.
+*/
 bool InputReader::readGameMapContent()
 {
+    const int width = m_gameMap->width();
+    std::vector<std::uint64_t> freeBits(m_gameMap->rowWords());
+
     skipNonNum();
-    char c;
-    for (int j = 0; j < m_gameMap->size().height(); ++j) {
-        for (int i = 0; i < m_gameMap->size().width(); ++i) {
-            if (m_file.eof()) {
-                m_errorString = "EOF reached when reading game map content";
-                return false;
-            }
-            if (!m_file.get(c)) {
-                m_errorString = "Unknown error occurred when reading game map content";
-                return false;
-            }
-
-            switch (c) {
-                case '0':
-                    m_gameMap->at(i, j)->isWall = false;
-                    break;
-                case '1':
-                    m_gameMap->at(i, j)->isWall = true;
-                    break;
-                default:
-                    m_errorString = std::string("Invalid game map content; character \'")
-                                    + c + std::string("\' found");
-                    return false;
-            }
+    for (int j = 0; j < m_gameMap->height(); ++j) {
+        if (m_pos == m_end) {
+            m_errorString = "EOF reached when reading game map content";
+            return false;
+        }
+
+        const int available = static_cast<int>(std::min<std::ptrdiff_t>(m_end - m_pos, width));
+        const int valid = RowParser::parse(m_pos, available, freeBits.data());
+        if (valid < available) {
+            m_errorString = std::string("Invalid game map content; character \'")
+                            + m_pos[valid] + std::string("\' found");
+            return false;
         }
+        if (available < width) {
+            m_errorString = "Unknown error occurred when reading game map content";
+            return false;
+        }
+
+        m_gameMap->setRow(j, freeBits.data());
+        m_pos += width;
+        skipNonNum();
+    }
+
+    return true;
+}
+
+bool InputReader::readQueries()
+{
+    // Note that skipNonNum() was already called at the end of readGameMapContent()
+    while (m_pos != m_end) {
+        const std::string number = std::to_string(m_queries.size());
+        Query query(Point(-1, -1), Point(-1, -1));
+        bool isRead = readNumber(query.start.rx());
+        skipNonNum();
+        isRead = readNumber(query.start.ry()) && isRead;
+        skipNonNum();
+        isRead = readNumber(query.finish.rx()) && isRead;
         skipNonNum();
+        if (m_pos == m_end) {
+            m_errorString = "EOF reached when reading query " + number;
+            return false;
+        }
+        if (!isRead || !readNumber(query.finish.ry()) || !validatePointBounds(query.start)
+                || !validatePointBounds(query.finish)) {
+            m_errorString = "Invalid query " + number + " specified";
+            return false;
+        }
+
+        // Transform to inner coordinate system (inverted Y-axis)
+        query.start.ry() = m_gameMap->size().height() - 1 - query.start.ry();
+        query.finish.ry() = m_gameMap->size().height() - 1 - query.finish.ry();
+        m_queries.push_back(query);
+
+        skipNonNum();
+    }
+
+    return true;
+}
+
+/*
+    Reads header and sections of binary map (see BinaryMap); cursor is left at the queries
+    section (or at the end if there is no one).
+*/
+bool InputReader::readBinaryMap()
+{
+    const char *data = m_pos;
+    const std::uint64_t size = m_end - m_pos;
+
+    BinaryMap::Header header;
+    if (size < sizeof(header)) {
+        m_errorString = "Invalid binary map header";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    BinaryMap::convertByteOrder(header);
+    if (header.version != BinaryMap::Version) {
+        m_errorString = "Unsupported binary map version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.headerSize < sizeof(header) || header.headerSize > size
+            || header.sectionCount > (size - header.headerSize) / sizeof(BinaryMap::Section)) {
+        m_errorString = "Invalid binary map header";
+        return false;
+    }
+    if (header.width <= 0 || header.height <= 0) {
+        m_errorString = "Invalid map dimensions";
+        return false;
+    }
+
+    const std::uint64_t rowWords = (std::uint64_t(header.width) + 63) / 64;
+    const std::uint64_t cellCount = std::uint64_t(header.width) * header.height;
+    const char *walls = 0;
+    const char *components = 0;
+    const char *landmarks = 0;
+    BinaryMap::LandmarksHeader landmarksHeader = BinaryMap::LandmarksHeader();
+    m_pos = m_end;
+    for (std::uint32_t i = 0; i < header.sectionCount; ++i) {
+        BinaryMap::Section section;
+        std::memcpy(&section, data + header.headerSize + i * sizeof(section), sizeof(section));
+        BinaryMap::convertByteOrder(section);
+        if (section.offset % BinaryMap::Alignment || section.offset > size
+                || section.size > size - section.offset) {
+            m_errorString = "Invalid binary map section table";
+            return false;
+        }
+
+        const char *begin = data + section.offset;
+        bool isValid = true;
+        switch (section.type) {
+            case BinaryMap::WallsSection:
+                isValid = section.size == rowWords * header.height * sizeof(std::uint64_t);
+                walls = begin;
+                break;
+            case BinaryMap::QueriesSection:
+                isValid = section.size % (4 * sizeof(std::int32_t)) == 0;
+                m_pos = begin;
+                m_end = begin + section.size;
+                break;
+            case BinaryMap::ComponentsSection:
+                isValid = section.size == cellCount * sizeof(std::int32_t);
+                components = begin;
+                break;
+            case BinaryMap::LandmarksSection:
+                isValid = section.size >= sizeof(landmarksHeader);
+                if (isValid) {
+                    std::memcpy(&landmarksHeader, begin, sizeof(landmarksHeader));
+                    BinaryMap::convertByteOrder(landmarksHeader);
+                    isValid = landmarksHeader.landmarkCount <= LandmarkIndex::MaxLandmarks
+                            && section.size == sizeof(landmarksHeader)
+                            + std::uint64_t(landmarksHeader.landmarkCount)
+                              * (sizeof(std::int32_t) + cellCount * sizeof(std::uint16_t));
+                }
+                landmarks = begin;
+                break;
+            default:
+                break;
+        }
+        if (!isValid) {
+            m_errorString = "Invalid binary map section " + std::to_string(section.type);
+            return false;
+        }
+    }
+    if (!walls) {
+        m_errorString = "Binary map has no walls section";
+        return false;
+    }
+
+    m_gameMap->resize(Size(header.width, header.height));
+    m_start = Point(header.startX, header.startY);
+    if (!validatePointBounds(m_start)) {
+        m_errorString = "Invalid start point specified";
+        return false;
+    }
+    m_finish = Point(header.finishX, header.finishY);
+    if (!validatePointBounds(m_finish)) {
+        m_errorString = "Invalid finish point specified";
+        return false;
+    }
+
+    // Bits beyond map width are cleared, as GameMap::setRow() requires
+    std::vector<std::uint64_t> freeBits(rowWords);
+    const std::uint64_t lastWordMask = header.width % 64
+            ? (std::uint64_t(1) << (header.width % 64)) - 1 : ~std::uint64_t(0);
+    for (int j = 0; j < header.height; ++j) {
+        const char *row = walls + j * rowWords * sizeof(std::uint64_t);
+        for (std::uint64_t k = 0; k < rowWords; ++k)
+            freeBits[k] = Endian::load<std::uint64_t>(row + k * sizeof(std::uint64_t));
+        freeBits.back() &= lastWordMask;
+        m_gameMap->setRow(j, freeBits.data());
+    }
+
+    std::vector<std::int32_t> labels;
+    if (m_componentsEnabled && components
+            && !m_gameMap->assignComponents(toHostArray(components, cellCount, labels))) {
+        m_errorString = "Invalid binary map section "
+                        + std::to_string(int(BinaryMap::ComponentsSection));
+        return false;
+    }
+
+    if (m_landmarkCount > 0 && landmarks) {
+        const char *cells = landmarks + sizeof(landmarksHeader);
+        const char *distances = cells + landmarksHeader.landmarkCount * sizeof(std::int32_t);
+        std::vector<std::int32_t> cellStorage;
+        std::vector<std::uint16_t> distanceStorage;
+        if (!m_gameMap->assignLandmarks(
+                    static_cast<int>(landmarksHeader.landmarkCount),
+                    toHostArray(cells, landmarksHeader.landmarkCount, cellStorage),
+                    toHostArray(distances, landmarksHeader.landmarkCount * cellCount,
+                                distanceStorage))) {
+            m_errorString = "Invalid binary map section "
+                            + std::to_string(int(BinaryMap::LandmarksSection));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool InputReader::readBinaryQueries()
+{
+    for (; m_pos != m_end; m_pos += 4 * sizeof(std::int32_t)) {
+        std::int32_t coordinates[4];
+        for (int i = 0; i < 4; ++i)
+            coordinates[i] = Endian::load<std::int32_t>(m_pos + i * sizeof(std::int32_t));
+        Query query(Point(coordinates[0], coordinates[1]), Point(coordinates[2], coordinates[3]));
+        if (!validatePointBounds(query.start) || !validatePointBounds(query.finish)) {
+            m_errorString = "Invalid query " + std::to_string(m_queries.size()) + " specified";
+            return false;
+        }
+
+        // Transform to inner coordinate system (inverted Y-axis)
+        query.start.ry() = m_gameMap->size().height() - 1 - query.start.ry();
+        query.finish.ry() = m_gameMap->size().height() - 1 - query.finish.ry();
+        m_queries.push_back(query);
     }
 
     return true;
@@ -1,9 +1,11 @@
 #ifndef INPUTREADER_H
 #define INPUTREADER_H
 
-#include <fstream>
 #include <string>
+#include <vector>
 #include "core/gamemap.h"
+#include "core/query.h"
+#include "util/mappedfile.h"
 #include "util/point.h"
 
 class InputReader
@@ -12,25 +14,49 @@ public:
     InputReader();
     ~InputReader();
 
-    bool read(const std::string &filePath);
+    void setComponentsEnabled(bool enabled);
+    void setClusterSize(int clusterSize,
+                        ClusterGraph::EntranceMode mode = ClusterGraph::SparseEntrances);
+    void setLandmarkCount(int count,
+                          LandmarkIndex::SelectionMode mode = LandmarkIndex::FarthestLandmarks);
+    bool read(const std::string &filePath, bool withQueries = false);
     std::string errorString() const;
+    double buildTime() const;
+    double clusterBuildTime() const;
+    double landmarkBuildTime() const;
 
     Point startPoint() const;
     Point finishPoint() const;
-    GameMap *gameMap() const;
+    const std::vector<Query> &queries() const;
+    const GameMap *gameMap() const;
 
 private:
-    std::ifstream m_file;
+    MappedFile m_file;
+    const char *m_pos;
+    const char *m_end;
     mutable std::string m_errorString;
     Point m_start;
     Point m_finish;
+    std::vector<Query> m_queries;
     GameMap *m_gameMap;
+    bool m_componentsEnabled;
+    int m_clusterSize;
+    ClusterGraph::EntranceMode m_entranceMode;
+    int m_landmarkCount;
+    LandmarkIndex::SelectionMode m_selectionMode;
+    double m_buildTime;
+    double m_clusterBuildTime;
+    double m_landmarkBuildTime;
 
     void skipNonNum();
+    bool readNumber(int &value, bool skipSpaces = false);
     bool readGameMapSize();
     bool readStartPoint();
     bool readFinishPoint();
     bool readGameMapContent();
+    bool readQueries();
+    bool readBinaryMap();
+    bool readBinaryQueries();
     bool validatePointBounds(const Point &p) const;
 };
 
@@ -1,4 +1,5 @@
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include "appcontroller.h"
 
@@ -8,9 +9,59 @@
 
     \b Usage.
 
-    ./ballpath input_file \n
+    ./ballpath [options] input_file \n
       or \n
-    ./ballpath input_file >output_file
+    ./ballpath [options] input_file >output_file
+
+    \b Options.
+
+    --batch -- perform all the queries from input file (see InputReader) against one loaded
+    map and write one result line per query; aggregate timing is written to error stream.\n
+    --threads N -- count of threads used for solving queries in batch mode (default is count
+    of hardware threads); results are written in input order anyway.\n
+    --engine NAME -- search algorithm: "auto" (default; fixed 9x9 bitboard search for ColorLines
+    board and A* for other sizes), "astar", "bidir" (bidirectional A*, for corridors and mazes),
+    "bfs" (bit-parallel breadth-first search), "jps" (Jump Point Search, for large open maps)
+    or "hpa" (hierarchical A* over clusters, for very large maps); see PathFinder. In batch
+    mode count of expanded nodes is reported (separately for both directions of bidirectional
+    A*).\n
+    --cluster-size N -- size of cluster side for "hpa" engine (default is 16); abstract graph
+    of clusters is built once when map is loaded, its build time and memory are reported by
+    --stats.\n
+    --hpa-optimal -- make "hpa" engine find exactly the shortest paths by placing entrance at
+    every border cell of clusters (abstract graph gets larger); by default paths may be longer
+    than the shortest ones (a few percent in total, but up to several times for short paths;
+    --stats reports how many of them are longer). See ClusterGraph.\n
+    --landmarks N -- compute distance tables of N landmarks when map is loaded (or load them
+    from binary input file, see ballpath-convert) and use them for A* heuristic ("auto" and
+    "astar" engines); on maps with walls and corridors search expands far fewer nodes. Tables
+    take 2 * N bytes per cell; their build time and memory are reported by --stats.\n
+    --landmark-selection NAME -- how landmarks are chosen: "farthest" (default; every next
+    landmark is the cell farthest from already chosen ones) or "random". See LandmarkIndex.\n
+    --components -- label connected components of empty cells when map is loaded, so queries
+    with unreachable finish point are answered without search; count of components is
+    reported in batch mode.\n
+    --format NAME -- output format: "text" (default; path with solve map), "path" (moves only,
+    e.g. "RUURR"), "rle" (run-length encoded moves, e.g. "1R2U2R"), "json" (one JSON object
+    with path and count of expanded nodes per line) or "binary" (see BinaryResult); compact
+    formats skip rendering of solve map. See ResultWriter for details.\n
+    --stats -- write statistics to error stream: time of parsing, building (with count of
+    components and memory of their labelling for --components), searching and writing, and
+    search counters (nodes expanded, pushed, decrease-key operations, maximal open list size,
+    closed list size); for "hpa" engine also count of paths longer than the shortest ones and
+    their mean and maximal ratio to the shortest length (checked by A* after timing); JSON
+    object is written for "json" output format.
+    Search counters except count of expanded nodes are collected only if project is built
+    with BALLPATH_STATS CMake option.\n
+    --serve -- persistent query mode: game map is loaded from \a input_file (which is optional
+    then) or by "load" command, and commands of line protocol are read from standard input:
+    loading of map, moving, placing and removing of balls, path queries. One response line is
+    written per command; game map and search scratch stay warm between commands. See Session
+    for protocol description.\n
+    --socket PATH -- socket server mode: clients connect to local (UNIX-domain) socket PATH and
+    share named game maps kept in memory; \a input_file (optional) is loaded as map "default".
+    Queries of all the clients are solved by pool of threads (see --threads); latency
+    histogram is reported by "stats" command. See SocketServer for protocol description.
 
     \b Input.
 
@@ -29,7 +80,7 @@
 
     \b Algorithm.
 
-    For path finding used algorithm called "A*" or "A-Star". \n
+    For path finding used algorithm called "A*" or "A-Star" by default. \n
     For details see PathFinder class description.
 
     \note Projects written in C++ with using of C++11 standard features, so you
@@ -42,10 +93,23 @@
 void printUsage()
 {
 #if defined(_WIN32) || defined(_WIN64)
-    std::cout << "Usage: ballpath.exe <input_file>" << std::endl;
+    std::cout << "Usage: ballpath.exe [options] <input_file>" << std::endl;
 #else
-    std::cout << "Usage: ./ballpath <input_file>" << std::endl;
+    std::cout << "Usage: ./ballpath [options] <input_file>" << std::endl;
 #endif
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --batch        perform all the queries from input file" << std::endl;
+    std::cout << "  --threads N    count of threads for batch mode" << std::endl;
+    std::cout << "  --engine NAME  search algorithm: auto (default), astar, bidir, bfs, jps or hpa" << std::endl;
+    std::cout << "  --cluster-size N  size of cluster side for hpa engine (default is 16)" << std::endl;
+    std::cout << "  --hpa-optimal  make hpa engine find exactly the shortest paths" << std::endl;
+    std::cout << "  --landmarks N  use N landmarks for A* heuristic" << std::endl;
+    std::cout << "  --landmark-selection NAME  farthest (default) or random" << std::endl;
+    std::cout << "  --components   label connected components at load time" << std::endl;
+    std::cout << "  --format NAME  output format: text (default), path, rle, json or binary" << std::endl;
+    std::cout << "  --stats        write search statistics to error stream" << std::endl;
+    std::cout << "  --serve        execute commands from standard input (input_file is optional)" << std::endl;
+    std::cout << "  --socket PATH  serve clients of local socket (input_file is optional)" << std::endl;
 }
 
 /*!
@@ -53,13 +117,96 @@ void printUsage()
 */
 int main(int argc, char *argv[])
 {
-    if (argc != 2) {
+    AppController app;
+    const char *filePath = 0;
+    bool isServeMode = false;
+    int clusterSize = 16;
+    ClusterGraph::EntranceMode entranceMode = ClusterGraph::SparseEntrances;
+    int landmarkCount = 0;
+    LandmarkIndex::SelectionMode selectionMode = LandmarkIndex::FarthestLandmarks;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--batch")) {
+            app.setBatchMode(true);
+        } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            app.setThreadCount(std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--serve")) {
+            app.setServeMode(true);
+            isServeMode = true;
+        } else if (!std::strcmp(argv[i], "--socket") && i + 1 < argc) {
+            app.setSocketPath(argv[++i]);
+            isServeMode = true;
+        } else if (!std::strcmp(argv[i], "--stats")) {
+            app.setStatsEnabled(true);
+        } else if (!std::strcmp(argv[i], "--components")) {
+            app.setComponentsEnabled(true);
+        } else if (!std::strcmp(argv[i], "--engine") && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (!std::strcmp(name, "auto")) {
+                app.setAlgorithm(PathFinder::Auto);
+            } else if (!std::strcmp(name, "astar")) {
+                app.setAlgorithm(PathFinder::AStar);
+            } else if (!std::strcmp(name, "bidir")) {
+                app.setAlgorithm(PathFinder::BidirectionalAStar);
+            } else if (!std::strcmp(name, "bfs")) {
+                app.setAlgorithm(PathFinder::BitBfs);
+            } else if (!std::strcmp(name, "jps")) {
+                app.setAlgorithm(PathFinder::Jps);
+            } else if (!std::strcmp(name, "hpa")) {
+                app.setAlgorithm(PathFinder::Hierarchical);
+            } else {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (!std::strcmp(argv[i], "--cluster-size") && i + 1 < argc) {
+            clusterSize = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--hpa-optimal")) {
+            entranceMode = ClusterGraph::AllEntrances;
+        } else if (!std::strcmp(argv[i], "--landmarks") && i + 1 < argc) {
+            landmarkCount = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--landmark-selection") && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (!std::strcmp(name, "farthest")) {
+                selectionMode = LandmarkIndex::FarthestLandmarks;
+            } else if (!std::strcmp(name, "random")) {
+                selectionMode = LandmarkIndex::RandomLandmarks;
+            } else {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (!std::strcmp(argv[i], "--format") && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (!std::strcmp(name, "text")) {
+                app.setOutputFormat(ResultWriter::TextFormat);
+            } else if (!std::strcmp(name, "path")) {
+                app.setOutputFormat(ResultWriter::PathFormat);
+            } else if (!std::strcmp(name, "rle")) {
+                app.setOutputFormat(ResultWriter::RunLengthFormat);
+            } else if (!std::strcmp(name, "json")) {
+                app.setOutputFormat(ResultWriter::JsonFormat);
+            } else if (!std::strcmp(name, "binary")) {
+                app.setOutputFormat(ResultWriter::BinaryFormat);
+            } else {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (argv[i][0] != '-' && !filePath) {
+            filePath = argv[i];
+        } else {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    app.setClusterSize(clusterSize, entranceMode);
+    app.setLandmarkCount(landmarkCount, selectionMode);
+
+    if (!filePath && !isServeMode) {
         printUsage();
         return EXIT_FAILURE;
     }
 
-    AppController app;
-    if (!app.exec(argv[1]))
+    if (!app.exec(filePath ? filePath : ""))
         return EXIT_FAILURE;
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,255 @@
+#include <cstdint>
+#include <cstring>
+#include "binarymap.h"
+#include "mapwriter.h"
+
+namespace {
+    /*!
+        Returns point \a p transformed from inner coordinate system of \a gameMap to
+        coordinate system of input file (inverted Y-axis).
+    */
+    Point toFilePoint(const GameMap &gameMap, const Point &p)
+    {
+        return Point(p.x(), gameMap.height() - 1 - p.y());
+    }
+
+    /*!
+        Returns \a offset rounded up to alignment of binary map sections.
+    */
+    std::uint64_t align(std::uint64_t offset)
+    {
+        return (offset + BinaryMap::Alignment - 1) / BinaryMap::Alignment
+                * BinaryMap::Alignment;
+    }
+} // anonymous namespace
+
+/*!
+    \class MapWriter
+    \brief Writes game map with queries to file in text or binary format.
+
+    Written file can be read back by InputReader. The first query is written as start and
+    finish points, the rest are written as additional queries. In binary format labelling
+    of connected components and landmark tables are written as well if game map has them
+    (see GameMap::buildComponents() and GameMap::buildLandmarks()).
+
+    \sa InputReader, BinaryMap
+*/
+
+/*!
+    Constructs writer of binary format.
+*/
+MapWriter::MapWriter()
+    : m_format(BinaryFormat)
+{
+}
+
+/*!
+    Sets output file \a format; by default BinaryFormat is used.
+*/
+void MapWriter::setFormat(Format format)
+{
+    m_format = format;
+}
+
+/*!
+    Returns output file format.
+*/
+MapWriter::Format MapWriter::format() const
+{
+    return m_format;
+}
+
+/*!
+    Writes \a gameMap and \a queries (in inner coordinate system, as returned by InputReader;
+    the first one is start and finish points) to \a filePath file.
+    \return true if operation finished successfully.
+    \sa errorString()
+*/
+bool MapWriter::write(const std::string &filePath, const GameMap &gameMap,
+                      const std::vector<Query> &queries)
+{
+    if (queries.empty()) {
+        m_errorString = "Start and finish points aren't specified";
+        return false;
+    }
+
+    std::ofstream file(filePath.c_str(), std::ios_base::out | std::ios_base::binary);
+    if (!file.good()) {
+        m_errorString = "Open file error: probably directory doesn't exist";
+        return false;
+    }
+
+    if (m_format == TextFormat)
+        writeText(file, gameMap, queries);
+    else
+        writeBinary(file, gameMap, queries);
+
+    file.close();
+    if (!file.good()) {
+        m_errorString = "Write file error";
+        return false;
+    }
+    return true;
+}
+
+/*!
+    Returns last error text description.
+    If there are no errors occurred -- returns empty string.
+*/
+std::string MapWriter::errorString() const
+{
+    return m_errorString;
+}
+
+/* private */
+
+void MapWriter::writeText(std::ofstream &file, const GameMap &gameMap,
+                          const std::vector<Query> &queries) const
+{
+    const Point start = toFilePoint(gameMap, queries[0].start);
+    const Point finish = toFilePoint(gameMap, queries[0].finish);
+    file << gameMap.height() << '\n' << gameMap.width() << '\n'
+         << '(' << start.x() << ',' << start.y() << ")\n"
+         << '(' << finish.x() << ',' << finish.y() << ")\n";
+
+    std::string row(gameMap.width() + 1, '\n');
+    for (int j = 0; j < gameMap.height(); ++j) {
+        const std::uint64_t *freeBits = gameMap.freeRow(j);
+        for (int i = 0; i < gameMap.width(); ++i)
+            row[i] = (freeBits[i / 64] >> (i % 64)) & 1 ? '0' : '1';
+        file.write(row.data(), row.size());
+    }
+
+    for (std::size_t q = 1; q < queries.size(); ++q) {
+        const Point queryStart = toFilePoint(gameMap, queries[q].start);
+        const Point queryFinish = toFilePoint(gameMap, queries[q].finish);
+        file << '(' << queryStart.x() << ',' << queryStart.y() << ")->("
+             << queryFinish.x() << ',' << queryFinish.y() << ")\n";
+    }
+}
+
+void MapWriter::writeBinary(std::ofstream &file, const GameMap &gameMap,
+                            const std::vector<Query> &queries) const
+{
+    const ComponentIndex *components = gameMap.components();
+    const LandmarkIndex *landmarks = gameMap.landmarks();
+    const std::uint64_t cellCount = std::uint64_t(gameMap.width()) * gameMap.height();
+
+    std::vector<BinaryMap::Section> sections;
+    BinaryMap::Section section = BinaryMap::Section();
+    section.type = BinaryMap::WallsSection;
+    section.size = std::uint64_t(gameMap.rowWords()) * gameMap.height() * sizeof(std::uint64_t);
+    sections.push_back(section);
+    if (queries.size() > 1) {
+        section.type = BinaryMap::QueriesSection;
+        section.size = (queries.size() - 1) * 4 * sizeof(std::int32_t);
+        sections.push_back(section);
+    }
+    if (components) {
+        section.type = BinaryMap::ComponentsSection;
+        section.size = cellCount * sizeof(std::int32_t);
+        sections.push_back(section);
+    }
+    if (landmarks) {
+        section.type = BinaryMap::LandmarksSection;
+        section.size = sizeof(BinaryMap::LandmarksHeader) + std::uint64_t(
+                    landmarks->landmarkCount()) * (sizeof(std::int32_t)
+                                                   + cellCount * sizeof(std::uint16_t));
+        sections.push_back(section);
+    }
+
+    std::uint64_t offset = sizeof(BinaryMap::Header) + sections.size() * sizeof(section);
+    for (BinaryMap::Section &s : sections) {
+        s.offset = align(offset);
+        offset = s.offset + s.size;
+    }
+
+    const Point start = toFilePoint(gameMap, queries[0].start);
+    const Point finish = toFilePoint(gameMap, queries[0].finish);
+    BinaryMap::Header header = BinaryMap::Header();
+    std::memcpy(header.magic, BinaryMap::Magic, sizeof(header.magic));
+    header.version = BinaryMap::Version;
+    header.headerSize = sizeof(header);
+    header.width = gameMap.width();
+    header.height = gameMap.height();
+    header.startX = start.x();
+    header.startY = start.y();
+    header.finishX = finish.x();
+    header.finishY = finish.y();
+    header.sectionCount = static_cast<std::uint32_t>(sections.size());
+    BinaryMap::convertByteOrder(header);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (BinaryMap::Section s : sections) {
+        BinaryMap::convertByteOrder(s);
+        file.write(reinterpret_cast<const char *>(&s), sizeof(s));
+    }
+
+    const char padding[BinaryMap::Alignment] = { 0 };
+    std::uint64_t written = sizeof(header) + sections.size() * sizeof(BinaryMap::Section);
+    for (const BinaryMap::Section &s : sections) {
+        file.write(padding, s.offset - written);
+        switch (s.type) {
+            case BinaryMap::WallsSection: {
+                std::vector<std::uint64_t> words(gameMap.rowWords());
+                for (int j = 0; j < gameMap.height(); ++j) {
+                    for (int k = 0; k < gameMap.rowWords(); ++k)
+                        words[k] = Endian::toLittle(gameMap.freeRow(j)[k]);
+                    file.write(reinterpret_cast<const char *>(words.data()),
+                               words.size() * sizeof(std::uint64_t));
+                }
+                break;
+            }
+            case BinaryMap::QueriesSection:
+                for (std::size_t q = 1; q < queries.size(); ++q) {
+                    const Point queryStart = toFilePoint(gameMap, queries[q].start);
+                    const Point queryFinish = toFilePoint(gameMap, queries[q].finish);
+                    const std::int32_t coordinates[4] = {
+                        Endian::toLittle<std::int32_t>(queryStart.x()),
+                        Endian::toLittle<std::int32_t>(queryStart.y()),
+                        Endian::toLittle<std::int32_t>(queryFinish.x()),
+                        Endian::toLittle<std::int32_t>(queryFinish.y())
+                    };
+                    file.write(reinterpret_cast<const char *>(coordinates), sizeof(coordinates));
+                }
+                break;
+            case BinaryMap::ComponentsSection: {
+                std::vector<std::int32_t> labels(gameMap.width());
+                for (int j = 0; j < gameMap.height(); ++j) {
+                    for (int i = 0; i < gameMap.width(); ++i)
+                        labels[i] = Endian::toLittle<std::int32_t>(
+                                    components->component(gameMap.index(i, j)));
+                    file.write(reinterpret_cast<const char *>(labels.data()),
+                               labels.size() * sizeof(std::int32_t));
+                }
+                break;
+            }
+            case BinaryMap::LandmarksSection: {
+                const int count = landmarks->landmarkCount();
+                BinaryMap::LandmarksHeader landmarksHeader = BinaryMap::LandmarksHeader();
+                landmarksHeader.landmarkCount = count;
+                BinaryMap::convertByteOrder(landmarksHeader);
+                file.write(reinterpret_cast<const char *>(&landmarksHeader),
+                           sizeof(landmarksHeader));
+                for (int i = 0; i < count; ++i) {
+                    const Point p = gameMap.point(landmarks->landmark(i));
+                    const std::int32_t cell = Endian::toLittle<std::int32_t>(
+                                p.y() * gameMap.width() + p.x());
+                    file.write(reinterpret_cast<const char *>(&cell), sizeof(cell));
+                }
+                std::vector<std::uint16_t> distances(std::size_t(gameMap.width()) * count);
+                for (int j = 0; j < gameMap.height(); ++j) {
+                    for (int i = 0; i < gameMap.width(); ++i) {
+                        const int index = gameMap.index(i, j);
+                        for (int k = 0; k < count; ++k)
+                            distances[i * count + k] = Endian::toLittle(
+                                        landmarks->distance(k, index));
+                    }
+                    file.write(reinterpret_cast<const char *>(distances.data()),
+                               distances.size() * sizeof(std::uint16_t));
+                }
+                break;
+            }
+        }
+        written = s.offset + s.size;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef MAPWRITER_H
+#define MAPWRITER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "core/gamemap.h"
+#include "core/query.h"
+
+class MapWriter
+{
+public:
+    enum Format { TextFormat, BinaryFormat };
+
+    MapWriter();
+
+    void setFormat(Format format);
+    Format format() const;
+
+    bool write(const std::string &filePath, const GameMap &gameMap,
+               const std::vector<Query> &queries);
+    std::string errorString() const;
+
+private:
+    Format m_format;
+    std::string m_errorString;
+
+    void writeText(std::ofstream &file, const GameMap &gameMap,
+                   const std::vector<Query> &queries) const;
+    void writeBinary(std::ofstream &file, const GameMap &gameMap,
+                     const std::vector<Query> &queries) const;
+};
+
+#endif // MAPWRITER_H
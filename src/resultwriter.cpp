@@ -1,4 +1,6 @@
+#include <cstring>
 #include <iostream>
+#include "binaryresult.h"
 #include "resultwriter.h"
 
 namespace {
@@ -11,6 +13,10 @@ namespace {
     \class ResultWriter
     \brief Provides simply way to print out formatted result on the screen.
 
+    Results are formatted into one output buffer, which is written out on the screen with
+    one call by flush(), so that even large solve maps and long batches cost no per-line
+    stream calls.
+
     \b Output \b format.
 
     1. If path not found then "There is no path" line appears.\n
@@ -23,24 +29,190 @@ namespace {
          - ball: 'O' character
          - empty cell: ' ' (whitespace) character
          - finish point: 'F' character
+
+    \b Batch \b output \b format.
+
+    One line per query, which starts with query itself in input format ("(x,y)->(x,y)")
+    followed by colon and one of:
+       - steps number and shortest path, e.g. "(0,0)->(2,5): 9: R, U, U, R, R, U, U, L, U"
+       - "There is no path" line if path not found
+       - error description if query is invalid (e.g. "Start point must be a ball")
+
+    \b Compact \b output \b formats.
+
+    Formats other than TextFormat never render solve map, so that output of huge maps costs
+    time proportional to path length only (see setFormat()):
+       - PathFormat: moves without separators, e.g. "RUURRUULU"; in batch mode every line
+         starts with query and colon like in batch text format.
+       - RunLengthFormat: moves with count of repeats before every run, e.g. "1R2U2R2U1L1U".
+       - JsonFormat: one JSON object per line (per query), e.g.
+         {"start":[0,0],"finish":[2,5],"found":true,"length":9,"path":"RUURRUULU","expanded":21};
+         "found" is false and there are no "length" and "path" if path not found, and there is
+         "error" with error description instead of all of these if query is invalid.
+       - BinaryFormat: records of BinaryResult layout.
+*/
+
+/*!
+    Constructs writer of TextFormat with empty output buffer.
+*/
+ResultWriter::ResultWriter()
+    : m_format(TextFormat), m_headerWritten(false)
+{
+}
+
+/*!
+    Sets output \a format; by default TextFormat is used.
+*/
+void ResultWriter::setFormat(Format format)
+{
+    m_format = format;
+}
+
+/*!
+    Returns output format.
 */
+ResultWriter::Format ResultWriter::format() const
+{
+    return m_format;
+}
+
+/*!
+    Reserves \a size bytes of output buffer, so that results of known size are written
+    without reallocations.
+*/
+void ResultWriter::reserve(std::size_t size)
+{
+    m_buffer.reserve(size);
+}
 
 /*!
-    Writes out formatted result on the screen.
+    Writes out formatted result of single query to output buffer.
     \param gameMap Game field that needed for writing solve map.
+    \param query Query in inner coordinate system (as returned by InputReader).
     \param path Sequence of steps that needed for writing path and steps number.
+    \param expandedCount Count of nodes expanded by search (for JsonFormat and BinaryFormat).
+    \sa flush()
 */
-bool ResultWriter::write(const GameMap &gameMap, const Path &path)
+void ResultWriter::write(const GameMap &gameMap, const Query &query, const Path &path,
+                         int expandedCount)
 {
+    if (m_format == JsonFormat || m_format == BinaryFormat) {
+        writeQueryResult(gameMap, query, path, expandedCount);
+        return;
+    }
+
     if (path.size() < 2) {
-        std::cout << "There is no path" << std::endl;
-    } else {
-        std::cout << "Shortest path: " << makePathString(path) << std::endl;
-        std::cout << "Steps number in path: " <<  path.size() - 1 << std::endl;
-        std::cout << "Solve map:" << std::endl;
-        std::cout << makeSolveMap(gameMap, path) << std::endl;
+        m_buffer += "There is no path\n";
+        return;
+    }
+
+    if (m_format == PathFormat) {
+        appendMoves(path);
+        m_buffer += '\n';
+        return;
+    }
+    if (m_format == RunLengthFormat) {
+        appendRunLengthMoves(path);
+        m_buffer += '\n';
+        return;
+    }
+
+    m_buffer.reserve(m_buffer.size() + 64 + 3 * path.size()
+                     + (gameMap.width() + 1) * std::size_t(gameMap.height()));
+    m_buffer += "Shortest path: ";
+    appendPath(path);
+    m_buffer += "\nSteps number in path: ";
+    appendNumber(path.length());
+    m_buffer += "\nSolve map:\n";
+    appendSolveMap(gameMap, path);
+    m_buffer += '\n';
+}
+
+/*!
+    Writes out one line of batch result for query \a query to output buffer.
+    \param gameMap Game field that query was performed at.
+    \param query Query in inner coordinate system (as returned by InputReader).
+    \param path Found path (or empty path if path not found).
+    \param expandedCount Count of nodes expanded by search (for JsonFormat and BinaryFormat).
+*/
+void ResultWriter::writeQueryResult(const GameMap &gameMap, const Query &query, const Path &path,
+                                    int expandedCount)
+{
+    if (m_format == JsonFormat) {
+        appendJsonRecord(gameMap, query, path, expandedCount, std::string());
+        return;
+    }
+    if (m_format == BinaryFormat) {
+        appendBinaryRecord(gameMap, query, path, expandedCount, true);
+        return;
+    }
+
+    appendQuery(gameMap, query);
+    if (path.size() < 2) {
+        m_buffer += ": There is no path\n";
+        return;
     }
-    return true;
+    m_buffer += ": ";
+    switch (m_format) {
+        case PathFormat:
+            appendMoves(path);
+            break;
+        case RunLengthFormat:
+            appendRunLengthMoves(path);
+            break;
+        default:
+            appendNumber(path.length());
+            m_buffer += ": ";
+            appendPath(path);
+            break;
+    }
+    m_buffer += '\n';
+}
+
+/*!
+    Writes out one line of batch result for invalid query \a query to output buffer.
+    \param gameMap Game field that query was performed at.
+    \param query Query in inner coordinate system (as returned by InputReader).
+    \param error Error description.
+*/
+void ResultWriter::writeQueryError(const GameMap &gameMap, const Query &query,
+                                   const std::string &error)
+{
+    if (m_format == JsonFormat) {
+        appendJsonRecord(gameMap, query, Path(), 0, error);
+        return;
+    }
+    if (m_format == BinaryFormat) {
+        appendBinaryRecord(gameMap, query, Path(), 0, false);
+        return;
+    }
+
+    appendQuery(gameMap, query);
+    m_buffer += ": ";
+    m_buffer += error;
+    m_buffer += '\n';
+}
+
+/*!
+    Writes out the whole output buffer on the screen with one call and clears it.
+    \return false if writing failed.
+*/
+bool ResultWriter::flush()
+{
+    std::cout.write(m_buffer.data(), m_buffer.size());
+    std::cout.flush();
+    m_buffer.clear();
+    return std::cout.good();
+}
+
+/*!
+    Moves the whole output buffer to \a output (instead of writing it on the screen) and
+    clears it; memory of both strings is kept for reuse.
+*/
+void ResultWriter::takeOutput(std::string &output)
+{
+    output.swap(m_buffer);
+    m_buffer.clear();
 }
 
 /* private */
@@ -50,36 +222,173 @@ char ResultWriter::actionChar(Action::Type actionType)
     return ActionCharArr[actionType];
 }
 
-std::string ResultWriter::makePathString(const Path &path)
+void ResultWriter::appendNumber(long long number)
 {
-    std::string res;
-    if (path.empty())
-        return res;
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    const bool isNegative = number < 0;
+    unsigned long long value = isNegative ? 0ULL - number : number;
+    do {
+        *--p = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    if (isNegative)
+        *--p = '-';
+    m_buffer.append(p, end);
+}
 
-    for (auto v : path)
-        res += actionChar(v.type) + std::string(", ");
-    res.erase(res.size() - 5, 5);
+/*
+    Appends steps of path separated by ", " (without the finish action).
+*/
+void ResultWriter::appendPath(const Path &path)
+{
+    const std::size_t length = path.length();
+    for (std::size_t i = 0; i < length; ++i) {
+        if (i)
+            m_buffer += ", ";
+        m_buffer += actionChar(path.move(i));
+    }
+}
 
-    return res;
+/*
+    Appends steps of path without separators (without the finish action).
+*/
+void ResultWriter::appendMoves(const Path &path)
+{
+    const std::size_t length = path.length();
+    for (std::size_t i = 0; i < length; ++i)
+        m_buffer += actionChar(path.move(i));
 }
 
-std::string ResultWriter::makeSolveMap(const GameMap &gameMap, const Path &path)
+/*
+    Appends steps of path as runs of equal steps: count of steps followed by step char.
+*/
+void ResultWriter::appendRunLengthMoves(const Path &path)
 {
-    std::string res;
+    const std::size_t length = path.length();
+    std::size_t runBegin = 0;
+    for (std::size_t i = 1; i <= length; ++i) {
+        if (i == length || path.move(i) != path.move(runBegin)) {
+            appendNumber(i - runBegin);
+            m_buffer += actionChar(path.move(runBegin));
+            runBegin = i;
+        }
+    }
+}
+
+void ResultWriter::appendQuery(const GameMap &gameMap, const Query &query)
+{
+    // Transform back to input coordinate system (inverted Y-axis)
+    const int h = gameMap.size().height();
+    m_buffer += '(';
+    appendNumber(query.start.x());
+    m_buffer += ',';
+    appendNumber(h - 1 - query.start.y());
+    m_buffer += ")->(";
+    appendNumber(query.finish.x());
+    m_buffer += ',';
+    appendNumber(h - 1 - query.finish.y());
+    m_buffer += ')';
+}
+
+/*
+    Renders rows of walls right into output buffer, then places actions (moves) by offset.
+*/
+void ResultWriter::appendSolveMap(const GameMap &gameMap, const Path &path)
+{
+    const int width = gameMap.size().width();
+    const std::size_t begin = m_buffer.size();
+    m_buffer.resize(begin + (width + 1) * std::size_t(gameMap.size().height()));
 
-    // Placing walls
+    char *p = &m_buffer[begin];
     for (int j = 0; j < gameMap.size().height(); ++j) {
-        for (int i = 0; i < gameMap.size().width(); ++i) {
-            res.push_back(gameMap.at(i, j)->isWall ? WallChar : EmptyChar);
+        const int first = gameMap.index(0, j);
+        for (int i = 0; i < width; ++i)
+            *p++ = gameMap.isWall(first + i) ? WallChar : EmptyChar;
+        *p++ = '\n';
+    }
+
+    char *map = &m_buffer[begin];
+    for (auto v : path)
+        map[v.point.x() + std::size_t(v.point.y()) * (width + 1)] = actionChar(v.type);
+}
+
+/*
+    Appends one JSON line of query result; \a error is non-empty if query is invalid.
+*/
+void ResultWriter::appendJsonRecord(const GameMap &gameMap, const Query &query, const Path &path,
+                                    int expandedCount, const std::string &error)
+{
+    const int h = gameMap.size().height();
+    m_buffer += "{\"start\":[";
+    appendNumber(query.start.x());
+    m_buffer += ',';
+    appendNumber(h - 1 - query.start.y());
+    m_buffer += "],\"finish\":[";
+    appendNumber(query.finish.x());
+    m_buffer += ',';
+    appendNumber(h - 1 - query.finish.y());
+    m_buffer += ']';
+
+    if (!error.empty()) {
+        m_buffer += ",\"error\":\"";
+        for (char c : error) {
+            if (c == '"' || c == '\\')
+                m_buffer += '\\';
+            m_buffer += c;
         }
-        res.push_back('\n');
+        m_buffer += "\"}\n";
+        return;
     }
 
-    // Placing actions (moves)
-    for (auto v : path) {
-        res.replace(v.point.x() + (v.point.y()) * (gameMap.size().width() + 1), 1, 1,
-                    actionChar(v.type));
+    if (path.size() < 2) {
+        m_buffer += ",\"found\":false";
+    } else {
+        m_buffer += ",\"found\":true,\"length\":";
+        appendNumber(path.length());
+        m_buffer += ",\"path\":\"";
+        appendMoves(path);
+        m_buffer += '"';
     }
+    m_buffer += ",\"expanded\":";
+    appendNumber(expandedCount);
+    m_buffer += "}\n";
+}
+
+/*
+    Appends BinaryResult record of query result (preceded by header if it's the first one).
+*/
+void ResultWriter::appendBinaryRecord(const GameMap &gameMap, const Query &query,
+                                      const Path &path, int expandedCount, bool isValid)
+{
+    if (!m_headerWritten) {
+        BinaryResult::Header header = BinaryResult::Header();
+        std::memcpy(header.magic, BinaryResult::Magic, sizeof(header.magic));
+        header.version = BinaryResult::Version;
+        header.headerSize = sizeof(header);
+        BinaryResult::convertByteOrder(header);
+        m_buffer.append(reinterpret_cast<const char *>(&header), sizeof(header));
+        m_headerWritten = true;
+    }
+
+    const int h = gameMap.size().height();
+    const std::size_t length = path.length();
+    BinaryResult::Record record = BinaryResult::Record();
+    record.startX = query.start.x();
+    record.startY = h - 1 - query.start.y();
+    record.finishX = query.finish.x();
+    record.finishY = h - 1 - query.finish.y();
+    record.status = !isValid ? BinaryResult::Invalid
+                             : length ? BinaryResult::Found : BinaryResult::NotFound;
+    record.length = static_cast<std::uint32_t>(length);
+    record.expanded = static_cast<std::uint32_t>(expandedCount);
+    BinaryResult::convertByteOrder(record);
+    m_buffer.append(reinterpret_cast<const char *>(&record), sizeof(record));
 
-    return res;
+    // Action::Left..Down are mapped to BinaryResult::Left..Down by subtracting 1
+    const std::size_t begin = m_buffer.size();
+    m_buffer.resize(begin + BinaryResult::movesSize(length), '\0');
+    for (std::size_t i = 0; i < length; ++i)
+        m_buffer[begin + i / 4] |= static_cast<char>((path.move(i) - Action::Left) << (i % 4 * 2));
 }
@@ -1,22 +1,51 @@
 #ifndef RESULTWRITER_H
 #define RESULTWRITER_H
 
+#include <cstddef>
 #include <string>
 #include "core/gamemap.h"
 #include "core/path.h"
+#include "core/query.h"
 
 class ResultWriter
 {
 
 public:
-    static bool write(const GameMap &gameMap, const Path &path);
+    enum Format { TextFormat, PathFormat, RunLengthFormat, JsonFormat, BinaryFormat };
 
-private:
     ResultWriter();
 
+    void setFormat(Format format);
+    Format format() const;
+
+    void reserve(std::size_t size);
+    void write(const GameMap &gameMap, const Query &query, const Path &path,
+               int expandedCount = 0);
+    void writeQueryResult(const GameMap &gameMap, const Query &query, const Path &path,
+                          int expandedCount = 0);
+    void writeQueryError(const GameMap &gameMap, const Query &query, const std::string &error);
+    bool flush();
+    void takeOutput(std::string &output);
+
+private:
+    Format m_format;
+    bool m_headerWritten;
+    std::string m_buffer;
+
+    ResultWriter(const ResultWriter &); // forbidden
+    ResultWriter &operator=(const ResultWriter &); // forbidden
+
     static char actionChar(Action::Type actionType);
-    static std::string makePathString(const Path &path);
-    static std::string makeSolveMap(const GameMap &gameMap, const Path &path);
+    void appendNumber(long long number);
+    void appendPath(const Path &path);
+    void appendMoves(const Path &path);
+    void appendRunLengthMoves(const Path &path);
+    void appendQuery(const GameMap &gameMap, const Query &query);
+    void appendSolveMap(const GameMap &gameMap, const Path &path);
+    void appendJsonRecord(const GameMap &gameMap, const Query &query, const Path &path,
+                          int expandedCount, const std::string &error);
+    void appendBinaryRecord(const GameMap &gameMap, const Query &query, const Path &path,
+                            int expandedCount, bool isValid);
 };
 
 #endif // RESULTWRITER_H
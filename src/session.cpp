@@ -0,0 +1,287 @@
+#include <cstdio>
+#include "appcontroller.h"
+#include "inputreader.h"
+#include "session.h"
+
+/*!
+    \class Session
+    \brief Keeps game map and search scratch warm between commands of line protocol.
+
+    Session is used by persistent query mode (see AppController::setServeMode()): game map is
+    loaded once and then modified by ball commands, while the same PathFinder (with its search
+    scratch) serves all the queries, so no per-query process start or input parsing is needed.
+
+    \b Protocol.
+
+    Every command is one line; every command except "quit" produces exactly one response line.
+    Points are in input file coordinate system (see InputReader).
+       - "load FILE" -- loads (or replaces) game map from text or binary FILE; response is
+         "ok WIDTHxHEIGHT".
+       - "query (x,y)->(x,y)" or just "(x,y)->(x,y)" -- finds path; response is one batch
+         result line in selected output format (see ResultWriter).
+       - "move (x,y)->(x,y)" -- moves ball to empty cell (path isn't checked); response is "ok".
+       - "place (x,y)" -- places ball to empty cell; response is "ok".
+       - "remove (x,y)" -- removes ball; response is "ok".
+       - "quit" -- finishes session.
+
+    If command fails, response is "error: " followed by error description (e.g.
+    "error: No map loaded"). Empty lines are ignored (and produce no response).
+
+    \sa AppController
+*/
+
+/*!
+    Constructs session without game map; call load() or execute "load" command first.
+*/
+Session::Session()
+    : m_gameMap(0), m_finder(0), m_algorithm(PathFinder::Auto), m_componentsEnabled(false),
+      m_clusterSize(0), m_entranceMode(ClusterGraph::SparseEntrances), m_landmarkCount(0),
+      m_selectionMode(LandmarkIndex::FarthestLandmarks)
+{
+}
+
+Session::~Session()
+{
+    delete m_finder;
+    delete m_gameMap;
+}
+
+/*!
+    Selects search \a algorithm for queries; by default PathFinder::Auto is used.
+*/
+void Session::setAlgorithm(PathFinder::Algorithm algorithm)
+{
+    m_algorithm = algorithm;
+    if (m_finder)
+        m_finder->setAlgorithm(algorithm);
+}
+
+/*!
+    Enables labelling of connected components of loaded maps if \a enabled is true; labelling
+    is kept up to date by ball commands.
+    \sa GameMap::buildComponents()
+*/
+void Session::setComponentsEnabled(bool enabled)
+{
+    m_componentsEnabled = enabled;
+}
+
+/*!
+    If \a clusterSize is positive, abstract graph for hierarchical search with clusters of
+    \a clusterSize x \a clusterSize cells and entrances placed according to \a mode is built
+    for loaded maps. Any cell change drops it, so after ball commands it's rebuilt lazily, by
+    the next valid query (see prepareIndices()); a series of ball commands costs one rebuild.
+    \sa GameMap::buildClusters()
+*/
+void Session::setClusterSize(int clusterSize, ClusterGraph::EntranceMode mode)
+{
+    m_clusterSize = clusterSize;
+    m_entranceMode = mode;
+}
+
+/*!
+    If \a count is positive, distance tables of \a count landmarks chosen according to \a mode
+    are built for loaded maps (or loaded from binary map files). Any cell change drops them, so
+    after ball commands they're rebuilt lazily, by the next valid query (see
+    prepareIndices()).
+    \sa GameMap::buildLandmarks()
+*/
+void Session::setLandmarkCount(int count, LandmarkIndex::SelectionMode mode)
+{
+    m_landmarkCount = count;
+    m_selectionMode = mode;
+}
+
+/*!
+    Sets \a format of query responses; by default ResultWriter::TextFormat is used.
+*/
+void Session::setOutputFormat(ResultWriter::Format format)
+{
+    m_writer.setFormat(format);
+}
+
+/*!
+    Loads game map from \a filePath file (replacing current one); queries of file are ignored.
+    \return false and sets \a error if file can't be read.
+*/
+bool Session::load(const std::string &filePath, std::string &error)
+{
+    InputReader reader;
+    reader.setComponentsEnabled(m_componentsEnabled);
+    reader.setClusterSize(m_clusterSize, m_entranceMode);
+    reader.setLandmarkCount(m_landmarkCount, m_selectionMode);
+    if (!reader.read(filePath)) {
+        error = reader.errorString();
+        return false;
+    }
+
+    delete m_finder;
+    if (!m_gameMap)
+        m_gameMap = new GameMap;
+    *m_gameMap = *reader.gameMap();
+    m_finder = new PathFinder(m_gameMap);
+    m_finder->setAlgorithm(m_algorithm);
+    return true;
+}
+
+/*!
+    Executes one protocol \a command and stores its response line (with trailing new line
+    character) into \a response; \a response is empty if command produces no response.
+    \return false if session is finished by "quit" command.
+*/
+bool Session::execute(const std::string &command, std::string &response)
+{
+    response.clear();
+
+    const std::size_t begin = command.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+        return true;
+    const std::size_t end = command.find_first_of(" \t\r", begin);
+    const std::string name = command.substr(begin, end == std::string::npos ? end : end - begin);
+    const std::string args = end == std::string::npos ? std::string() : command.substr(end);
+
+    if (name == "quit")
+        return false;
+
+    if (name == "load") {
+        executeLoad(args, response);
+    } else if (!m_gameMap) {
+        response = "error: No map loaded\n";
+    } else if (name == "query") {
+        executeQuery(args, response);
+    } else if (name[0] == '(') {
+        executeQuery(command, response);
+    } else if (name == "move" || name == "place" || name == "remove") {
+        executeBallCommand(name, args, response);
+    } else {
+        response = "error: Unknown command\n";
+    }
+    return true;
+}
+
+/*!
+    Parses point of \a args in "(x,y)" format (spaces are allowed) and transforms it from
+    input coordinate system to inner one of \a gameMap.
+    \return false if \a args has another format or point is out of game map.
+*/
+bool Session::parsePoint(const std::string &args, const GameMap &gameMap, Point &point)
+{
+    int x, y;
+    int length = 0;
+    if (std::sscanf(args.c_str(), " (%d ,%d ) %n", &x, &y, &length) != 2
+            || length != static_cast<int>(args.size()))
+        return false;
+    return toInnerPoint(x, y, gameMap, point);
+}
+
+/*!
+    Parses query of \a args in "(x,y)->(x,y)" format (spaces are allowed) and transforms it
+    from input coordinate system to inner one of \a gameMap.
+    \return false if \a args has another format or any point is out of game map.
+*/
+bool Session::parseQuery(const std::string &args, const GameMap &gameMap, Query &query)
+{
+    int x1, y1, x2, y2;
+    int length = 0;
+    if (std::sscanf(args.c_str(), " (%d ,%d ) -> (%d ,%d ) %n", &x1, &y1, &x2, &y2,
+                    &length) != 4
+            || length != static_cast<int>(args.size()))
+        return false;
+    return toInnerPoint(x1, y1, gameMap, query.start)
+            && toInnerPoint(x2, y2, gameMap, query.finish);
+}
+
+/* private */
+
+void Session::executeQuery(const std::string &args, std::string &response)
+{
+    Query query;
+    if (!parseQuery(args, *m_gameMap, query)) {
+        response = "error: Invalid query specified\n";
+        return;
+    }
+
+    std::string error;
+    if (!AppController::validateQuery(*m_gameMap, query, error)) {
+        m_writer.writeQueryError(*m_gameMap, query, error);
+    } else {
+        prepareIndices();
+        m_finder->findPath(query.start, query.finish);
+        m_writer.writeQueryResult(*m_gameMap, query, m_finder->path(),
+                                  m_finder->expandedCount());
+    }
+    m_writer.takeOutput(response);
+}
+
+void Session::executeLoad(const std::string &args, std::string &response)
+{
+    const std::size_t begin = args.find_first_not_of(" \t");
+    const std::size_t end = args.find_last_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        response = "error: File path isn't specified\n";
+        return;
+    }
+
+    std::string error;
+    if (!load(args.substr(begin, end - begin + 1), error)) {
+        response = "error: " + error + '\n';
+        return;
+    }
+    response = "ok " + std::to_string(m_gameMap->width()) + 'x'
+            + std::to_string(m_gameMap->height()) + '\n';
+}
+
+void Session::executeBallCommand(const std::string &name, const std::string &args,
+                                 std::string &response)
+{
+    Query query;
+    const bool isParsed = name == "move" ? parseQuery(args, *m_gameMap, query)
+                                         : parsePoint(args, *m_gameMap, query.start);
+    if (!isParsed) {
+        response = "error: Invalid point specified\n";
+        return;
+    }
+
+    if (name != "place" && !m_gameMap->isWall(query.start)) {
+        response = "error: There is no ball at the point\n";
+        return;
+    }
+    if (name != "remove" && m_gameMap->isWall(name == "move" ? query.finish : query.start)) {
+        response = "error: Ball can be placed only to empty cell\n";
+        return;
+    }
+
+    if (name == "move")
+        m_gameMap->moveBall(query.start, query.finish);
+    else if (name == "place")
+        m_gameMap->placeBall(query.start);
+    else
+        m_gameMap->removeBall(query.start);
+    response = "ok\n";
+}
+
+/*!
+    Rebuilds abstract graph and landmark tables of game map if they're enabled (see
+    setClusterSize() and setLandmarkCount()) but were dropped by ball commands since the last
+    query.
+*/
+void Session::prepareIndices()
+{
+    if (m_clusterSize > 0 && !m_gameMap->clusters())
+        m_gameMap->buildClusters(m_clusterSize, m_entranceMode);
+    if (m_landmarkCount > 0 && !m_gameMap->landmarks())
+        m_gameMap->buildLandmarks(m_landmarkCount, m_selectionMode);
+}
+
+/*
+    Transforms point \a x, \a y from input coordinate system (inverted Y-axis) to inner one of
+    \a gameMap.
+    \return false if point is out of game map.
+*/
+bool Session::toInnerPoint(int x, int y, const GameMap &gameMap, Point &point)
+{
+    if (x < 0 || y < 0 || x >= gameMap.width() || y >= gameMap.height())
+        return false;
+    point = Point(x, gameMap.height() - 1 - y);
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <string>
+#include "resultwriter.h"
+#include "core/gamemap.h"
+#include "core/pathfinder.h"
+#include "core/query.h"
+
+class Session
+{
+public:
+    Session();
+    ~Session();
+
+    void setAlgorithm(PathFinder::Algorithm algorithm);
+    void setComponentsEnabled(bool enabled);
+    void setClusterSize(int clusterSize, ClusterGraph::EntranceMode mode);
+    void setLandmarkCount(int count, LandmarkIndex::SelectionMode mode);
+    void setOutputFormat(ResultWriter::Format format);
+
+    bool load(const std::string &filePath, std::string &error);
+    bool execute(const std::string &command, std::string &response);
+
+    static bool parsePoint(const std::string &args, const GameMap &gameMap, Point &point);
+    static bool parseQuery(const std::string &args, const GameMap &gameMap, Query &query);
+
+private:
+    GameMap *m_gameMap;
+    PathFinder *m_finder;
+    ResultWriter m_writer;
+    PathFinder::Algorithm m_algorithm;
+    bool m_componentsEnabled;
+    int m_clusterSize;
+    ClusterGraph::EntranceMode m_entranceMode;
+    int m_landmarkCount;
+    LandmarkIndex::SelectionMode m_selectionMode;
+
+    Session(const Session &); // forbidden
+    Session &operator=(const Session &); // forbidden
+
+    void executeQuery(const std::string &args, std::string &response);
+    void executeLoad(const std::string &args, std::string &response);
+    void executeBallCommand(const std::string &name, const std::string &args,
+                            std::string &response);
+    void prepareIndices();
+    static bool toInnerPoint(int x, int y, const GameMap &gameMap, Point &point);
+};
+
+#endif // SESSION_H
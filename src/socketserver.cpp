@@ -0,0 +1,609 @@
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include "appcontroller.h"
+#include "inputreader.h"
+#include "session.h"
+#include "socketserver.h"
+#include "util/threadpool.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    /*!
+        Splits \a command into command name and the rest arguments string.
+    */
+    void splitCommand(const std::string &command, std::string &name, std::string &args)
+    {
+        const std::size_t begin = command.find_first_not_of(" \t\r");
+        if (begin == std::string::npos) {
+            name.clear();
+            args.clear();
+            return;
+        }
+        const std::size_t end = command.find_first_of(" \t\r", begin);
+        name = command.substr(begin, end == std::string::npos ? end : end - begin);
+        args = end == std::string::npos ? std::string() : command.substr(end);
+    }
+} // anonymous namespace
+
+/*!
+    \class SocketServer
+    \brief Serves path queries of many clients over local (UNIX-domain) stream socket.
+
+    Server keeps named game maps in memory; every map is immutable and shared by all the
+    clients, so processes on the same host don't load their own copies of large maps. Every
+    client connection is read by its own thread, while queries of all the clients are solved by
+    one worker pool (see ThreadPool). Every worker keeps its own PathFinder (search scratch)
+    per map, so workers share maps without any locking.
+
+    \b Protocol.
+
+    Line protocol like the one of Session, but maps are named and can't be modified. Every
+    command except "quit" produces exactly one response line; responses are written in order
+    of commands, so client may send many commands without waiting for responses.
+       - "load NAME FILE" -- loads (or replaces) map NAME from text or binary FILE; response
+         is "ok WIDTHxHEIGHT". Queries which are in progress keep using the previous map.
+       - "unload NAME" -- removes map NAME; response is "ok".
+       - "maps" -- response is "ok" followed by names of all the loaded maps.
+       - "query NAME (x,y)->(x,y)" -- finds path at map NAME; response is one batch result
+         line in selected output format (see ResultWriter).
+       - "stats" -- response is "ok" followed by latency histogram of all the requests served
+         so far (see below).
+       - "quit" -- closes connection.
+       - "shutdown" -- stops server; response is "ok".
+
+    If command fails, response is "error: " followed by error description.
+
+    \b Latency \b histogram.
+
+    Latency of request is time from receiving of command to its response ready (including time
+    spent in worker pool queue). Requests are counted in buckets by powers of 2 microseconds:
+    "requests=N p50<Aus p99<Bus hist=1:N,2:N,4:N,..." where "K:N" means that N requests took
+    less than K (and at least K/2) microseconds; empty buckets are omitted. The same histogram
+    is written to error stream when server stops.
+
+    \note Server is available on POSIX systems only.
+    \sa Session, AppController
+*/
+
+/*!
+    \struct SocketServer::Connection
+    \brief Client connection and thread reading it.
+*/
+struct SocketServer::Connection
+{
+    int fd;
+    std::thread thread;
+    std::atomic<bool> isFinished;
+};
+
+/*!
+    \struct SocketServer::Request
+    \brief One command of client and its response.
+*/
+struct SocketServer::Request
+{
+    std::string response;
+    Clock::time_point received;
+};
+
+/*!
+    \struct SocketServer::Batch
+    \brief Counter of requests of one read from connection which are solved by worker pool.
+*/
+struct SocketServer::Batch
+{
+    std::mutex mutex;
+    std::condition_variable allDone;
+    int pending;
+
+    Batch() : pending(0) {}
+
+    void add()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++pending;
+    }
+
+    void finish()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0)
+            allDone.notify_all();
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (pending > 0)
+            allDone.wait(lock);
+    }
+};
+
+/*!
+    Constructs server without maps; by default count of hardware threads is used for worker
+    pool.
+*/
+SocketServer::SocketServer()
+    : m_threadCount(ThreadPool::idealThreadCount()), m_algorithm(PathFinder::Auto),
+      m_componentsEnabled(false), m_clusterSize(0), m_entranceMode(ClusterGraph::SparseEntrances),
+      m_landmarkCount(0), m_selectionMode(LandmarkIndex::FarthestLandmarks),
+      m_outputFormat(ResultWriter::TextFormat), m_pool(0),
+      m_listenFd(-1), m_stop(false)
+{
+    m_wakeFds[0] = m_wakeFds[1] = -1;
+    for (int i = 0; i < LatencyBuckets; ++i)
+        m_latency[i].store(0);
+}
+
+SocketServer::~SocketServer()
+{
+    delete m_pool;
+}
+
+/*!
+    Sets count of worker threads solving queries to \a count.
+*/
+void SocketServer::setThreadCount(int count)
+{
+    m_threadCount = count < 1 ? 1 : count;
+}
+
+/*!
+    Selects search \a algorithm; by default PathFinder::Auto is used.
+*/
+void SocketServer::setAlgorithm(PathFinder::Algorithm algorithm)
+{
+    m_algorithm = algorithm;
+}
+
+/*!
+    Enables labelling of connected components of loaded maps if \a enabled is true.
+    \sa GameMap::buildComponents()
+*/
+void SocketServer::setComponentsEnabled(bool enabled)
+{
+    m_componentsEnabled = enabled;
+}
+
+/*!
+    If \a clusterSize is positive, abstract graph for hierarchical search with clusters of
+    \a clusterSize x \a clusterSize cells and entrances placed according to \a mode is built
+    for loaded maps (once per map; it's shared by all the workers).
+    \sa GameMap::buildClusters()
+*/
+void SocketServer::setClusterSize(int clusterSize, ClusterGraph::EntranceMode mode)
+{
+    m_clusterSize = clusterSize;
+    m_entranceMode = mode;
+}
+
+/*!
+    If \a count is positive, distance tables of \a count landmarks chosen according to \a mode
+    are built for loaded maps (or loaded from binary map files); they're shared by all the
+    workers.
+    \sa GameMap::buildLandmarks()
+*/
+void SocketServer::setLandmarkCount(int count, LandmarkIndex::SelectionMode mode)
+{
+    m_landmarkCount = count;
+    m_selectionMode = mode;
+}
+
+/*!
+    Sets \a format of query responses; by default ResultWriter::TextFormat is used.
+    ResultWriter::BinaryFormat isn't supported (exec() fails).
+*/
+void SocketServer::setOutputFormat(ResultWriter::Format format)
+{
+    m_outputFormat = format;
+}
+
+/*!
+    Loads map \a name from \a filePath file (replacing map with the same name).
+    \return false and sets \a error if file can't be read.
+*/
+bool SocketServer::load(const std::string &name, const std::string &filePath,
+                        std::string &error)
+{
+    InputReader reader;
+    reader.setComponentsEnabled(m_componentsEnabled);
+    reader.setClusterSize(m_clusterSize, m_entranceMode);
+    reader.setLandmarkCount(m_landmarkCount, m_selectionMode);
+    if (!reader.read(filePath)) {
+        error = reader.errorString();
+        return false;
+    }
+
+    MapPtr map(new GameMap(*reader.gameMap()));
+    std::lock_guard<std::mutex> lock(m_mapsMutex);
+    m_maps[name] = map;
+    return true;
+}
+
+/*!
+    Listens \a socketPath socket and serves clients until "shutdown" command.
+    \return false and sets \a error if socket can't be created.
+*/
+bool SocketServer::exec(const std::string &socketPath, std::string &error)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)socketPath;
+    error = "Socket server isn't supported on this platform";
+    return false;
+#else
+    if (m_outputFormat == ResultWriter::BinaryFormat) {
+        error = "Binary output format isn't supported by socket server";
+        return false;
+    }
+
+    sockaddr_un address = sockaddr_un();
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        error = "Invalid socket path specified";
+        return false;
+    }
+    socketPath.copy(address.sun_path, socketPath.size());
+
+    // Remove stale socket of previous run (but never a regular file)
+    struct stat status;
+    if (!stat(socketPath.c_str(), &status) && S_ISSOCK(status.st_mode))
+        unlink(socketPath.c_str());
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listenFd < 0 || bind(m_listenFd, reinterpret_cast<sockaddr *>(&address),
+                               sizeof(address))
+            || listen(m_listenFd, SOMAXCONN)
+            || fcntl(m_listenFd, F_SETFL, fcntl(m_listenFd, F_GETFL) | O_NONBLOCK)
+            || pipe(m_wakeFds)) {
+        error = "Socket error: can't listen " + socketPath;
+        if (m_listenFd >= 0)
+            close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+    fcntl(m_wakeFds[1], F_SETFL, fcntl(m_wakeFds[1], F_GETFL) | O_NONBLOCK);
+    std::signal(SIGPIPE, SIG_IGN); // closed clients are detected by send() errors
+
+    m_pool = new ThreadPool(m_threadCount);
+    m_workerFinders.assign(m_threadCount, std::map<std::string, WorkerFinder>());
+
+    // Only this thread touches listening socket; connection threads wake it up by self-pipe
+    pollfd fds[2] = { pollfd(), pollfd() };
+    fds[0].fd = m_listenFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_wakeFds[0];
+    fds[1].events = POLLIN;
+    while (!m_stop) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[1].revents || !fds[0].revents)
+            continue; // woken up to stop
+        const int fd = accept(m_listenFd, 0, 0);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN
+                    || errno == EWOULDBLOCK)
+                continue;
+            break;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK); // may be inherited on some systems
+
+        reapConnections(false);
+        Connection *connection = new Connection;
+        connection->fd = fd;
+        connection->isFinished = false;
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        m_connections.push_back(connection);
+        connection->thread = std::thread(&SocketServer::serveConnection, this, connection);
+    }
+
+    m_stop = true;
+    close(m_listenFd);
+    m_listenFd = -1;
+    unlink(socketPath.c_str());
+    reapConnections(true);
+    close(m_wakeFds[0]);
+    close(m_wakeFds[1]);
+    m_wakeFds[0] = m_wakeFds[1] = -1;
+    delete m_pool;
+    m_pool = 0;
+
+    std::cerr << latencyReport() << std::endl;
+    return true;
+#endif
+}
+
+/* private */
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+/*!
+    Reads commands of \a connection and writes responses until client closes connection,
+    sends "quit" command or server stops. Commands of one read are executed together, so
+    queries pipelined by client are solved in parallel.
+*/
+void SocketServer::serveConnection(Connection *connection)
+{
+    std::string input;
+    std::string output;
+    std::vector<std::string> lines;
+    char buffer[65536];
+
+    for (;;) {
+        const ssize_t count = recv(connection->fd, buffer, sizeof(buffer), 0);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            break;
+        input.append(buffer, count);
+
+        lines.clear();
+        std::size_t pos = 0;
+        for (std::size_t end; (end = input.find('\n', pos)) != std::string::npos; pos = end + 1)
+            lines.push_back(input.substr(pos, end - pos));
+        input.erase(0, pos);
+        if (lines.empty())
+            continue;
+
+        const bool isOpen = executeLines(lines, output);
+        std::size_t sent = 0;
+        while (sent < output.size()) {
+            const ssize_t n = send(connection->fd, output.data() + sent, output.size() - sent, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            sent += n;
+        }
+        if (!isOpen || sent < output.size())
+            break;
+    }
+
+    shutdown(connection->fd, SHUT_RDWR); // client sees end of stream; socket is closed by reaper
+    connection->isFinished = true;
+    if (m_stop) {
+        // Wakes up exec(); pipe is closed only after all the connections are joined
+        const char byte = 0;
+        ssize_t n;
+        do {
+            n = write(m_wakeFds[1], &byte, 1);
+        } while (n < 0 && errno == EINTR);
+    }
+}
+
+/*!
+    Joins threads of finished connections and closes their sockets; if \a all is true, all
+    the connections are shut down and joined.
+*/
+void SocketServer::reapConnections(bool all)
+{
+    std::vector<Connection *> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        for (std::size_t i = 0; i < m_connections.size(); ) {
+            Connection *connection = m_connections[i];
+            if (all && !connection->isFinished)
+                shutdown(connection->fd, SHUT_RDWR);
+            if (all || connection->isFinished) {
+                finished.push_back(connection);
+                m_connections[i] = m_connections.back();
+                m_connections.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    for (Connection *connection : finished) {
+        connection->thread.join();
+        close(connection->fd);
+        delete connection;
+    }
+}
+
+#endif
+
+/*!
+    Executes \a lines commands of one read and stores their responses in order to \a output.
+    \return false if connection must be closed.
+*/
+bool SocketServer::executeLines(const std::vector<std::string> &lines, std::string &output)
+{
+    std::vector<Request> requests(lines.size());
+    Batch batch;
+    bool isQuit = false;
+    for (std::size_t i = 0; i < lines.size() && !isQuit; ++i)
+        executeCommand(lines[i], requests[i], batch, isQuit);
+    batch.wait();
+
+    output.clear();
+    for (const Request &request : requests)
+        output += request.response;
+    return !isQuit;
+}
+
+/*!
+    Executes one \a command storing its response into \a request; queries are submitted to
+    worker pool and counted in \a batch. Sets \a isQuit if connection must be closed.
+*/
+void SocketServer::executeCommand(const std::string &command, Request &request, Batch &batch,
+                                  bool &isQuit)
+{
+    request.received = Clock::now();
+
+    std::string name;
+    std::string args;
+    splitCommand(command, name, args);
+    if (name.empty())
+        return;
+
+    if (name == "query") {
+        std::string mapName;
+        std::string queryArgs;
+        splitCommand(args, mapName, queryArgs);
+        MapPtr map = findMap(mapName);
+        if (!map) {
+            request.response = "error: Unknown map\n";
+        } else {
+            batch.add();
+            m_pool->submit([this, mapName, map, queryArgs, &request, &batch](int worker) {
+                solveQuery(worker, mapName, map, queryArgs, request);
+                batch.finish();
+            });
+            return; // latency is recorded by worker
+        }
+    } else if (name == "load") {
+        std::string mapName;
+        std::string filePath;
+        splitCommand(args, mapName, filePath);
+        const std::size_t begin = filePath.find_first_not_of(" \t");
+        const std::size_t end = filePath.find_last_not_of(" \t\r");
+        std::string error;
+        if (begin == std::string::npos) {
+            request.response = "error: File path isn't specified\n";
+        } else if (!load(mapName, filePath.substr(begin, end - begin + 1), error)) {
+            request.response = "error: " + error + '\n';
+        } else {
+            MapPtr map = findMap(mapName);
+            request.response = "ok " + std::to_string(map->width()) + 'x'
+                    + std::to_string(map->height()) + '\n';
+        }
+    } else if (name == "unload") {
+        std::string mapName;
+        std::string rest;
+        splitCommand(args, mapName, rest);
+        std::lock_guard<std::mutex> lock(m_mapsMutex);
+        request.response = m_maps.erase(mapName) ? "ok\n" : "error: Unknown map\n";
+    } else if (name == "maps") {
+        request.response = "ok";
+        std::lock_guard<std::mutex> lock(m_mapsMutex);
+        for (const auto &entry : m_maps)
+            request.response += ' ' + entry.first;
+        request.response += '\n';
+    } else if (name == "stats") {
+        request.response = "ok " + latencyReport() + '\n';
+    } else if (name == "quit") {
+        isQuit = true;
+        return;
+    } else if (name == "shutdown") {
+        request.response = "ok\n";
+        isQuit = true;
+        m_stop = true; // exec() is woken up once response is sent
+    } else {
+        request.response = "error: Unknown command\n";
+    }
+    recordLatency(request);
+}
+
+/*!
+    Solves query \a args at shared \a map named \a name by PathFinder of \a worker and stores
+    response into \a request. Runs in worker thread.
+*/
+void SocketServer::solveQuery(int worker, const std::string &name, const MapPtr &map,
+                              const std::string &args, Request &request)
+{
+    // Finders of unloaded maps are dropped, finder of replaced map is recreated
+    std::map<std::string, WorkerFinder> &finders = m_workerFinders[worker];
+    for (auto it = finders.begin(); it != finders.end(); ) {
+        if (it->second.map.expired())
+            finders.erase(it++);
+        else
+            ++it;
+    }
+    WorkerFinder &entry = finders[name];
+    if (entry.map.lock() != map) {
+        entry.map = map;
+        entry.finder.reset(new PathFinder(map.get()));
+        entry.finder->setAlgorithm(m_algorithm);
+    }
+
+    Query query;
+    if (!Session::parseQuery(args, *map, query)) {
+        request.response = "error: Invalid query specified\n";
+    } else {
+        ResultWriter writer;
+        writer.setFormat(m_outputFormat);
+        std::string error;
+        if (!AppController::validateQuery(*map, query, error)) {
+            writer.writeQueryError(*map, query, error);
+        } else {
+            entry.finder->findPath(query.start, query.finish);
+            writer.writeQueryResult(*map, query, entry.finder->path(),
+                                    entry.finder->expandedCount());
+        }
+        writer.takeOutput(request.response);
+    }
+    recordLatency(request);
+}
+
+/*!
+    Counts latency of \a request (from receiving to now) in latency histogram.
+*/
+void SocketServer::recordLatency(Request &request)
+{
+    long long usecs = std::chrono::duration_cast<std::chrono::microseconds>(
+                Clock::now() - request.received).count();
+    int bucket = 0;
+    while (usecs > 0 && bucket < LatencyBuckets - 1) {
+        usecs >>= 1;
+        ++bucket;
+    }
+    ++m_latency[bucket];
+}
+
+/*!
+    Returns latency histogram of all the requests (see class description).
+*/
+std::string SocketServer::latencyReport() const
+{
+    long long counts[LatencyBuckets];
+    long long total = 0;
+    for (int i = 0; i < LatencyBuckets; ++i)
+        total += counts[i] = m_latency[i].load();
+
+    std::string p50;
+    std::string p99;
+    std::string histogram;
+    long long accumulated = 0;
+    for (int i = 0; i < LatencyBuckets; ++i) {
+        if (!counts[i])
+            continue;
+        const std::string bound = std::to_string(1LL << i);
+        accumulated += counts[i];
+        if (p50.empty() && 2 * accumulated >= total)
+            p50 = bound;
+        if (p99.empty() && 100 * accumulated >= 99 * total)
+            p99 = bound;
+        histogram += (histogram.empty() ? "" : ",") + bound + ':' + std::to_string(counts[i]);
+    }
+
+    std::string report = "requests=" + std::to_string(total);
+    if (total)
+        report += " p50<" + p50 + "us p99<" + p99 + "us hist=" + histogram;
+    return report;
+}
+
+/*!
+    Returns map \a name or null pointer if there is no such map.
+*/
+SocketServer::MapPtr SocketServer::findMap(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(m_mapsMutex);
+    std::map<std::string, MapPtr>::const_iterator it = m_maps.find(name);
+    return it == m_maps.end() ? MapPtr() : it->second;
+}
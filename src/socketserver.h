@@ -0,0 +1,90 @@
+#ifndef SOCKETSERVER_H
+#define SOCKETSERVER_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "resultwriter.h"
+#include "core/gamemap.h"
+#include "core/pathfinder.h"
+
+class ThreadPool;
+
+class SocketServer
+{
+public:
+    SocketServer();
+    ~SocketServer();
+
+    void setThreadCount(int count);
+    void setAlgorithm(PathFinder::Algorithm algorithm);
+    void setComponentsEnabled(bool enabled);
+    void setClusterSize(int clusterSize, ClusterGraph::EntranceMode mode);
+    void setLandmarkCount(int count, LandmarkIndex::SelectionMode mode);
+    void setOutputFormat(ResultWriter::Format format);
+
+    bool load(const std::string &name, const std::string &filePath, std::string &error);
+    bool exec(const std::string &socketPath, std::string &error);
+
+    static const int LatencyBuckets = 32;
+
+private:
+    typedef std::shared_ptr<const GameMap> MapPtr;
+
+    struct Connection;
+    struct Request;
+    struct Batch;
+
+    /*!
+        \struct SocketServer::WorkerFinder
+        \brief PathFinder of one worker bound to one shared map.
+    */
+    struct WorkerFinder
+    {
+        std::weak_ptr<const GameMap> map;
+        std::shared_ptr<PathFinder> finder;
+    };
+
+    int m_threadCount;
+    PathFinder::Algorithm m_algorithm;
+    bool m_componentsEnabled;
+    int m_clusterSize;
+    ClusterGraph::EntranceMode m_entranceMode;
+    int m_landmarkCount;
+    LandmarkIndex::SelectionMode m_selectionMode;
+    ResultWriter::Format m_outputFormat;
+
+    std::mutex m_mapsMutex;
+    std::map<std::string, MapPtr> m_maps;
+
+    ThreadPool *m_pool;
+    std::vector<std::map<std::string, WorkerFinder> > m_workerFinders; //!< Per worker.
+
+    int m_listenFd; //!< Owned by thread of exec().
+    int m_wakeFds[2]; //!< Self-pipe: connection threads wake up exec() by writing to it.
+    std::atomic<bool> m_stop;
+    std::mutex m_connectionsMutex;
+    std::vector<Connection *> m_connections;
+
+    std::atomic<long long> m_latency[LatencyBuckets]; //!< Request count per latency bucket.
+
+    SocketServer(const SocketServer &); // forbidden
+    SocketServer &operator=(const SocketServer &); // forbidden
+
+    void serveConnection(Connection *connection);
+    void reapConnections(bool all);
+    bool executeLines(const std::vector<std::string> &lines, std::string &output);
+    void executeCommand(const std::string &command, Request &request, Batch &batch,
+                        bool &isQuit);
+    void solveQuery(int worker, const std::string &name, const MapPtr &map,
+                    const std::string &args, Request &request);
+    void recordLatency(Request &request);
+    std::string latencyReport() const;
+    MapPtr findMap(const std::string &name);
+};
+
+#endif // SOCKETSERVER_H
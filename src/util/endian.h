@@ -0,0 +1,69 @@
+#ifndef ENDIAN_H
+#define ENDIAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/*!
+    \namespace Endian
+    \brief Conversion of integers between host and little-endian byte order of binary files.
+
+    Values are assembled byte by byte, so conversion doesn't depend on byte order of host;
+    on little-endian hosts compiler reduces it to plain memory access.
+*/
+
+namespace Endian {
+
+/*!
+    Returns true if host stores integers in little-endian byte order, i.e. if little-endian
+    arrays of binary files can be used right from memory.
+*/
+inline bool isLittleEndianHost()
+{
+    const std::uint16_t probe = 1;
+    return *reinterpret_cast<const unsigned char *>(&probe) == 1;
+}
+
+/*!
+    Returns integer of type \a T stored in little-endian byte order at \a data.
+*/
+template <typename T>
+inline T load(const char *data)
+{
+    typedef typename std::make_unsigned<T>::type Unsigned;
+    Unsigned value = 0;
+    for (std::size_t i = sizeof(T); i-- > 0; )
+        value = static_cast<Unsigned>(value << 8) | static_cast<unsigned char>(data[i]);
+    return static_cast<T>(value);
+}
+
+/*!
+    Stores integer \a value in little-endian byte order to \a data.
+*/
+template <typename T>
+inline void store(T value, char *data)
+{
+    typedef typename std::make_unsigned<T>::type Unsigned;
+    Unsigned bits = static_cast<Unsigned>(value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        data[i] = static_cast<char>(bits & 0xFF);
+        bits = static_cast<Unsigned>(bits >> 8);
+    }
+}
+
+/*!
+    Converts integer \a value from host to little-endian byte order or back (both conversions
+    are the same byte swap, or no-op on little-endian host).
+*/
+template <typename T>
+inline T toLittle(T value)
+{
+    T result;
+    store(value, reinterpret_cast<char *>(&result));
+    return result;
+}
+
+} // namespace Endian
+
+#endif // ENDIAN_H
@@ -0,0 +1,147 @@
+#include "util/mappedfile.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*!
+    \class MappedFile
+    \brief Read-only memory mapping of whole file.
+
+    File content is available as contiguous byte array (see data()) without copying it into
+    user buffers: pages are loaded by operating system on first access. Mapping is released
+    by close() or destructor.
+
+    Empty file is opened successfully and has null data() and zero size().
+*/
+
+/*!
+    Constructs closed file object.
+*/
+MappedFile::MappedFile()
+    : m_data(0), m_size(0), m_isOpen(false)
+#if defined(_WIN32) || defined(_WIN64)
+    , m_file(INVALID_HANDLE_VALUE), m_mapping(0)
+#endif
+{
+}
+
+/*!
+    Releases mapping.
+*/
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+/*!
+    Maps file \a filePath into memory (closing previously opened file).
+    \return false if file can't be opened or mapped.
+*/
+bool MappedFile::open(const std::string &filePath)
+{
+    close();
+
+#if defined(_WIN32) || defined(_WIN64)
+    m_file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                         FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size)) {
+        close();
+        return false;
+    }
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    if (m_size > 0) {
+        m_mapping = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+        if (!m_mapping) {
+            close();
+            return false;
+        }
+        m_data = static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_data) {
+            close();
+            return false;
+        }
+    }
+#else
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    m_size = static_cast<std::size_t>(st.st_size);
+    if (m_size > 0) {
+        void *data = mmap(0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            m_size = 0;
+            return false;
+        }
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char *>(data);
+    }
+    ::close(fd); // mapping stays valid after descriptor is closed
+#endif
+
+    m_isOpen = true;
+    return true;
+}
+
+/*!
+    Releases mapping; does nothing if file isn't open.
+*/
+void MappedFile::close()
+{
+#if defined(_WIN32) || defined(_WIN64)
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+    m_mapping = 0;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_data)
+        munmap(const_cast<char *>(m_data), m_size);
+#endif
+    m_data = 0;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+/*!
+    Returns true if file is mapped.
+*/
+bool MappedFile::isOpen() const
+{
+    return m_isOpen;
+}
+
+/*!
+    Returns pointer to the first byte of file content.
+*/
+const char *MappedFile::data() const
+{
+    return m_data;
+}
+
+/*!
+    Returns size of file in bytes.
+*/
+std::size_t MappedFile::size() const
+{
+    return m_size;
+}
@@ -0,0 +1,33 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const std::string &filePath);
+    void close();
+    bool isOpen() const;
+
+    const char *data() const;
+    std::size_t size() const;
+
+private:
+    const char *m_data;
+    std::size_t m_size;
+    bool m_isOpen;
+#if defined(_WIN32) || defined(_WIN64)
+    void *m_file;
+    void *m_mapping;
+#endif
+
+    MappedFile(const MappedFile &); // forbidden
+    MappedFile &operator=(const MappedFile &); // forbidden
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,135 @@
+#include "util/rowparser.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define ROWPARSER_HAS_AVX2
+#endif
+
+namespace {
+
+/*
+    Parses up to 64 characters; returns index of the first invalid character or count.
+*/
+int parseWordScalar(const char *text, int count, std::uint64_t &word)
+{
+    word = 0;
+    for (int k = 0; k < count; ++k) {
+        const char c = text[k];
+        if ((c | 1) != '1')
+            return k;
+        word |= std::uint64_t(c == '0') << k;
+    }
+    return count;
+}
+
+#if !defined(__SSE2__)
+int parseScalar(const char *text, int count, std::uint64_t *freeBits)
+{
+    for (int i = 0; i < count; i += 64) {
+        const int length = count - i < 64 ? count - i : 64;
+        const int valid = parseWordScalar(text + i, length, freeBits[i / 64]);
+        if (valid < length)
+            return i + valid;
+    }
+    return count;
+}
+#endif
+
+#if defined(__SSE2__)
+int parseSse2(const char *text, int count, std::uint64_t *freeBits)
+{
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i one = _mm_set1_epi8('1');
+    int i = 0;
+    for (; i + 64 <= count; i += 64) {
+        std::uint64_t word = 0;
+        for (int k = 0; k < 64; k += 16) {
+            const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i + k));
+            const unsigned zeros = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, zero));
+            const unsigned ones = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, one));
+            if ((zeros | ones) != 0xffff)
+                return i + k + __builtin_ctz(~(zeros | ones));
+            word |= std::uint64_t(zeros) << k;
+        }
+        freeBits[i / 64] = word;
+    }
+    if (i == count)
+        return count;
+    const int valid = parseWordScalar(text + i, count - i, freeBits[i / 64]);
+    return i + valid;
+}
+#endif
+
+#if defined(ROWPARSER_HAS_AVX2)
+__attribute__((target("avx2")))
+int parseAvx2(const char *text, int count, std::uint64_t *freeBits)
+{
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i one = _mm256_set1_epi8('1');
+    int i = 0;
+    for (; i + 64 <= count; i += 64) {
+        const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i));
+        const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i + 32));
+        const std::uint64_t zeros =
+                std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, zero)))
+                | std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, zero))))
+                  << 32;
+        const std::uint64_t ones =
+                std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, one)))
+                | std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, one))))
+                  << 32;
+        if (~(zeros | ones))
+            return i + __builtin_ctzll(~(zeros | ones));
+        freeBits[i / 64] = zeros;
+    }
+    if (i == count)
+        return count;
+    const int valid = parseWordScalar(text + i, count - i, freeBits[i / 64]);
+    return i + valid;
+}
+#endif
+
+typedef int (*ParseFunction)(const char *, int, std::uint64_t *);
+
+ParseFunction selectParser()
+{
+#if defined(ROWPARSER_HAS_AVX2)
+    __builtin_cpu_init(); // may be called before constructors of libgcc
+    if (__builtin_cpu_supports("avx2"))
+        return parseAvx2;
+#endif
+#if defined(__SSE2__)
+    return parseSse2;
+#else
+    return parseScalar;
+#endif
+}
+
+const ParseFunction BestParser = selectParser();
+
+} // anonymous namespace
+
+/*!
+    \namespace RowParser
+    \brief Converts text rows of '0' and '1' characters into packed bit rows.
+
+    The widest instruction set available is selected at run time: AVX2 (32 characters per
+    compare), SSE2 (16 characters per compare) or scalar code on other platforms. Characters
+    are compared with '0' and '1' and comparison masks are taken as bits, so validation and
+    packing are done by the same few instructions.
+*/
+
+/*!
+    Parses \a count characters of \a text into \a freeBits packed as GameMap::freeRow(): bit
+    (i % 64) of word (i / 64) is set if character i is '0' (empty cell); bits beyond \a count
+    are zero. \a freeBits must have room for (\a count + 63) / 64 words.
+    \return index of the first character that is neither '0' nor '1' (content of \a freeBits
+    is undefined then) or \a count if all the characters are valid.
+*/
+int RowParser::parse(const char *text, int count, std::uint64_t *freeBits)
+{
+    return BestParser(text, count, freeBits);
+}
@@ -0,0 +1,12 @@
+#ifndef ROWPARSER_H
+#define ROWPARSER_H
+
+#include <cstdint>
+
+namespace RowParser {
+
+int parse(const char *text, int count, std::uint64_t *freeBits);
+
+} // namespace RowParser
+
+#endif // ROWPARSER_H
@@ -0,0 +1,154 @@
+#include "util/threadpool.h"
+
+/*!
+    \class ThreadPool
+    \brief Fixed-size pool of worker threads with work-stealing scheduling.
+
+    Every worker has its own task deque. Worker takes tasks from the back of its own deque
+    and, when it's empty, steals tasks from the front of other workers' deques. So if tasks
+    were distributed evenly but some of them turned out to be much longer than others, idle
+    workers take over the rest of the work from busy ones.
+
+    Every task receives index of worker which runs it (from range [0, threadCount())), so
+    tasks can use per-worker state (e.g. search scratch) without any locking.
+*/
+
+/*!
+    Constructs pool and starts \a threadCount worker threads.
+*/
+ThreadPool::ThreadPool(int threadCount)
+    : m_nextWorker(0), m_queued(0), m_pending(0), m_stop(false)
+{
+    if (threadCount < 1)
+        threadCount = 1;
+    for (int i = 0; i < threadCount; ++i)
+        m_workers.push_back(new Worker);
+    for (int i = 0; i < threadCount; ++i)
+        m_threads.push_back(std::thread(&ThreadPool::run, this, i));
+}
+
+/*!
+    Waits for all the submitted tasks to finish and stops worker threads.
+*/
+ThreadPool::~ThreadPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskAvailable.notify_all();
+    for (auto &thread : m_threads)
+        thread.join();
+    for (auto worker : m_workers)
+        delete worker;
+}
+
+/*!
+    Returns count of worker threads.
+*/
+int ThreadPool::threadCount() const
+{
+    return static_cast<int>(m_workers.size());
+}
+
+/*!
+    Submits \a task to deques of workers in round-robin manner.
+*/
+void ThreadPool::submit(const Task &task)
+{
+    submit(m_nextWorker++ % threadCount(), task);
+}
+
+/*!
+    Submits \a task to deque of worker with index \a worker; task still can be stolen by
+    another worker.
+*/
+void ThreadPool::submit(int worker, const Task &task)
+{
+    Worker *w = m_workers[worker % threadCount()];
+    {
+        // Counters are updated together with deque, so wait() never sees a gap
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<std::mutex> workerLock(w->mutex);
+        w->tasks.push_back(task);
+        ++m_queued;
+        ++m_pending;
+    }
+    m_taskAvailable.notify_one();
+}
+
+/*!
+    Blocks until all the submitted tasks are finished.
+*/
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_pending > 0)
+        m_allDone.wait(lock);
+}
+
+/*!
+    Returns count of hardware threads (at least 1).
+*/
+int ThreadPool::idealThreadCount()
+{
+    int count = static_cast<int>(std::thread::hardware_concurrency());
+    return count > 0 ? count : 1;
+}
+
+/* private */
+
+/*!
+    Main loop of worker thread with index \a worker.
+*/
+void ThreadPool::run(int worker)
+{
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (m_queued == 0 && !m_stop)
+                m_taskAvailable.wait(lock);
+            if (m_queued == 0 && m_stop)
+                return;
+        }
+
+        Task task;
+        if (!takeTask(worker, task))
+            continue; // another worker was faster
+
+        task(worker);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_pending == 0)
+            m_allDone.notify_all();
+    }
+}
+
+/*!
+    Takes task from the back of own deque of \a worker or steals it from the front of another
+    worker's deque. Returns false if all the deques are empty.
+*/
+bool ThreadPool::takeTask(int worker, Task &task)
+{
+    const int count = threadCount();
+    for (int i = 0; i < count; ++i) {
+        Worker *w = m_workers[(worker + i) % count];
+        std::unique_lock<std::mutex> lock(w->mutex);
+        if (w->tasks.empty())
+            continue;
+        if (i == 0) {
+            task = std::move(w->tasks.back());
+            w->tasks.pop_back();
+        } else {
+            task = std::move(w->tasks.front());
+            w->tasks.pop_front();
+        }
+        lock.unlock();
+
+        std::lock_guard<std::mutex> globalLock(m_mutex);
+        --m_queued;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,51 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    typedef std::function<void(int worker)> Task;
+
+    explicit ThreadPool(int threadCount);
+    ~ThreadPool();
+
+    int threadCount() const;
+    void submit(const Task &task);
+    void submit(int worker, const Task &task);
+    void wait();
+
+    static int idealThreadCount();
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<Worker *> m_workers;
+    std::vector<std::thread> m_threads;
+    std::atomic<int> m_nextWorker;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_allDone;
+    int m_queued;  //!< Count of tasks in all the deques.
+    int m_pending; //!< Count of submitted but not finished tasks.
+    bool m_stop;
+
+    ThreadPool(const ThreadPool &); // forbidden
+    ThreadPool &operator=(const ThreadPool &); // forbidden
+
+    void run(int worker);
+    bool takeTask(int worker, Task &task);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,93 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "inputreader.h"
+#include "mapwriter.h"
+
+/*!
+    \file convert.cpp
+    \brief Converts input files between text and binary formats (see InputReader).
+
+    Input format is recognized automatically; output format is binary by default. Binary
+    files are loaded without parsing and may keep precomputed labelling of connected
+    components and landmark tables, so archived maps cost almost no time at startup.
+
+    Usage: ./ballpath-convert [--text] [--components] [--landmarks N] [--landmark-selection
+    NAME] input_file output_file
+
+    --text -- write text format instead of binary one.\n
+    --components -- label connected components (or keep labelling of binary input file) and
+    store it in binary output file.\n
+    --landmarks N -- compute distance tables of N landmarks for A* heuristic (or keep tables
+    of binary input file) and store them in binary output file; they take 2 * N bytes per
+    cell.\n
+    --landmark-selection NAME -- how landmarks are chosen: "farthest" (default) or "random";
+    see LandmarkIndex.
+*/
+
+/*!
+    Prints out usage of application.
+*/
+void printUsage()
+{
+    std::cout << "Usage: ./ballpath-convert [options] <input_file> <output_file>" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --text         write text format (default is binary)" << std::endl;
+    std::cout << "  --components   store labelling of connected components" << std::endl;
+    std::cout << "  --landmarks N  store distance tables of N landmarks" << std::endl;
+    std::cout << "  --landmark-selection NAME  farthest (default) or random" << std::endl;
+}
+
+/*!
+    Entry point.
+*/
+int main(int argc, char *argv[])
+{
+    InputReader reader;
+    MapWriter writer;
+    const char *filePaths[2] = { 0, 0 };
+    int landmarkCount = 0;
+    LandmarkIndex::SelectionMode selectionMode = LandmarkIndex::FarthestLandmarks;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--text")) {
+            writer.setFormat(MapWriter::TextFormat);
+        } else if (!std::strcmp(argv[i], "--components")) {
+            reader.setComponentsEnabled(true);
+        } else if (!std::strcmp(argv[i], "--landmarks") && i + 1 < argc) {
+            landmarkCount = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--landmark-selection") && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (!std::strcmp(name, "farthest")) {
+                selectionMode = LandmarkIndex::FarthestLandmarks;
+            } else if (!std::strcmp(name, "random")) {
+                selectionMode = LandmarkIndex::RandomLandmarks;
+            } else {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (argv[i][0] != '-' && !filePaths[1]) {
+            filePaths[filePaths[0] ? 1 : 0] = argv[i];
+        } else {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!filePaths[1]) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    reader.setLandmarkCount(landmarkCount, selectionMode);
+    if (!reader.read(filePaths[0], true)) {
+        std::cout << reader.errorString() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!writer.write(filePaths[1], *reader.gameMap(), reader.queries())) {
+        std::cout << writer.errorString() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}